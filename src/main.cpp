@@ -15,6 +15,7 @@
 #include "representation/Graph.hpp"
 #include "representation/Method.hpp"
 #include "representation/Parameters.hpp"
+#include "representation/Solution.hpp"
 #include "utils/random_generator.hpp"
 
 /**
@@ -328,6 +329,90 @@ std::unique_ptr<Method> parse(int argc, const char **argv) {
                 //
                 ));
 
+        options.allow_unrecognised_options().add_options()(
+            "neighbors_order",
+            "Order of the neighbors of each vertex (id, weight), weight puts the "
+            "heaviest neighbors first",
+            cxxopts::value<std::string>()->default_value("id"));
+
+        options.allow_unrecognised_options().add_options()(
+            "graph_mode",
+            "Storage of the adjacency (auto, dense, sparse), sparse avoids any structure "
+            "quadratic in the number of vertices, auto chooses according to the density",
+            cxxopts::value<std::string>()->default_value("auto"));
+
+        options.allow_unrecognised_options().add_options()(
+            "reduction",
+            "Reduction of the instance (none, native), none loads the instance reduced "
+            "beforehand (instances/reduced_[problem]), native reduces the original graph "
+            "(instances/original_graphs) and writes the solutions with the original ids",
+            cxxopts::value<std::string>()->default_value("none"));
+
+        options.allow_unrecognised_options().add_options()(
+            "relabel",
+            "Relabelling of the vertices (none, rcm), rcm numbers the vertices of the same "
+            "weight in reverse Cuthill-McKee order to improve the memory locality, the "
+            "solutions are written with the original ids",
+            cxxopts::value<std::string>()->default_value("none"));
+
+        options.allow_unrecognised_options().add_options()(
+            "conflicts_layout",
+            "Layout of the conflict matrix of the solutions (vertex, color), vertex "
+            "keeps the conflicts of a vertex with all the colors contiguous",
+            cxxopts::value<std::string>()->default_value("vertex"));
+
+        options.allow_unrecognised_options().add_options()(
+            "threads",
+            "Number of threads of the MCTS, they share the best found solution",
+            cxxopts::value<int>()->default_value("1"));
+
+        options.allow_unrecognised_options().add_options()(
+            "parallelization",
+            "Parallelization of the MCTS with several threads (root, tree), root : each "
+            "thread searches its own tree, tree : the threads search the same tree with "
+            "virtual loss (memory of one tree)",
+            cxxopts::value<std::string>()->default_value("root"));
+
+        options.allow_unrecognised_options().add_options()(
+            "simulation_threads",
+            "Number of threads running the local searches of each MCTS thread, the "
+            "thread keeps on selecting leaves while their local searches run",
+            cxxopts::value<int>()->default_value("1"));
+
+        options.allow_unrecognised_options().add_options()(
+            "transposition_table",
+            "log2 of the number of slots of the transposition table of each MCTS tree, the "
+            "moves leading to a partial solution equivalent to one already in the tree "
+            "with a lower score are skipped (0 for no table)",
+            cxxopts::value<int>()->default_value("0"));
+
+        options.allow_unrecognised_options().add_options()(
+            "tree_memory",
+            "Memory budget of each MCTS tree in MB, the subtrees with the fewest visits "
+            "are evicted when the tree exceeds it and expanded again later (0 for no "
+            "limit). The limit is approximate : it counts the nodes in the tree, not the "
+            "chunks allocated for them which are kept for the next nodes",
+            cxxopts::value<int>()->default_value("0"));
+
+        options.allow_unrecognised_options().add_options()(
+            "checkpoint",
+            "Checkpoint file of the MCTS (trees, best solution, helpers and random "
+            "generators) written at each period and at the end of the search, let empty "
+            "for no checkpoint",
+            cxxopts::value<std::string>()->default_value(""));
+
+        options.allow_unrecognised_options().add_options()(
+            "checkpoint_period",
+            "Period between two checkpoints in seconds",
+            cxxopts::value<int>()->default_value("600"));
+
+        options.allow_unrecognised_options().add_options()(
+            "resume",
+            "Checkpoint file of the MCTS to resume the search from, the instance, the "
+            "problem, the graph options (neighbors_order, reduction, graph_mode, "
+            "relabel), the number of threads and the parallelization must be the same",
+            cxxopts::value<std::string>()->default_value(""));
+
         options.allow_unrecognised_options().add_options()(
             "o,output_directory",
             "output file, let empty if output to stdout, else directory, file name will "
@@ -381,9 +466,16 @@ std::unique_ptr<Method> parse(int argc, const char **argv) {
                        problem);
             exit(1);
         }
+        // the instantiation of the solution and the local searches for the problem
+        Solution::weighted = problem == "wvcp";
 
         const std::string instance = result["instance"].as<std::string>();
-        Graph::init_graph(instance, problem);
+        const std::string neighbors_order = result["neighbors_order"].as<std::string>();
+        const std::string graph_mode = result["graph_mode"].as<std::string>();
+        const std::string reduction = result["reduction"].as<std::string>();
+        const std::string relabel = result["relabel"].as<std::string>();
+        Graph::init_graph(
+            instance, problem, neighbors_order, graph_mode, reduction, relabel);
 
         const std::string method = result["method"].as<std::string>();
 
@@ -413,9 +505,7 @@ std::unique_ptr<Method> parse(int argc, const char **argv) {
         int bound_nb_colors = result["bound_nb_colors"].as<int>();
         // if bound_nb_colors is -1, set it to the max degree + 1
         if (bound_nb_colors == -1) {
-            bound_nb_colors =
-                (*std::max_element(Graph::g->degrees.begin(), Graph::g->degrees.end())) +
-                1;
+            bound_nb_colors = Graph::g->max_degree + 1;
         }
 
         const std::string local_search = result["local_search"].as<std::string>();
@@ -434,6 +524,73 @@ std::unique_ptr<Method> parse(int argc, const char **argv) {
                     O_time);
         }
 
+        const std::string conflicts_layout = result["conflicts_layout"].as<std::string>();
+        if (conflicts_layout != "vertex" and conflicts_layout != "color") {
+            fmt::print(stderr,
+                       "unknown conflicts layout {}\n"
+                       "select :\n"
+                       "\tvertex (conflicts of a vertex contiguous)\n"
+                       "\tcolor (conflicts of a color contiguous)",
+                       conflicts_layout);
+            exit(1);
+        }
+
+        const int nb_threads = result["threads"].as<int>();
+        if (nb_threads < 1) {
+            fmt::print(stderr, "the number of threads must be at least 1\n");
+            exit(1);
+        }
+
+        const std::string parallelization = result["parallelization"].as<std::string>();
+        if (parallelization != "root" and parallelization != "tree") {
+            fmt::print(stderr,
+                       "unknown parallelization {}\n"
+                       "select :\n"
+                       "\troot (one tree per thread)\n"
+                       "\ttree (one tree shared by the threads)",
+                       parallelization);
+            exit(1);
+        }
+
+        const int nb_simulation_threads = result["simulation_threads"].as<int>();
+        if (nb_simulation_threads < 1) {
+            fmt::print(stderr, "the number of simulation threads must be at least 1\n");
+            exit(1);
+        }
+        if (nb_simulation_threads > 1 and adaptive.rfind("neural_net", 0) == 0) {
+            fmt::print(stderr,
+                       "the neural net helper needs the result of a local search "
+                       "before choosing the next operator, use 1 simulation thread\n");
+            exit(1);
+        }
+
+        const int transposition_table = result["transposition_table"].as<int>();
+        if (transposition_table < 0 or transposition_table > 32) {
+            fmt::print(stderr, "the size of the transposition table must be in [0, 32]\n");
+            exit(1);
+        }
+        // the solutions keep their key for the table from their first move
+        Solution::transposition_keys = transposition_table > 0;
+
+        const int tree_memory = result["tree_memory"].as<int>();
+        if (tree_memory < 0) {
+            fmt::print(stderr, "the memory budget of the tree must be positive\n");
+            exit(1);
+        }
+
+        const std::string checkpoint = result["checkpoint"].as<std::string>();
+        const int checkpoint_period = result["checkpoint_period"].as<int>();
+        if (checkpoint_period < 1) {
+            fmt::print(stderr, "the period between two checkpoints must be at least 1\n");
+            exit(1);
+        }
+        const std::string resume = result["resume"].as<std::string>();
+        if ((checkpoint != "" or resume != "") and adaptive.rfind("neural_net", 0) == 0) {
+            fmt::print(stderr,
+                       "the state of the neural net helper can't be checkpointed\n");
+            exit(1);
+        }
+
         const std::string output_directory = result["output_directory"].as<std::string>();
 
         // init parameters
@@ -457,6 +614,20 @@ std::unique_ptr<Method> parse(int argc, const char **argv) {
                                                      simulation,
                                                      O_time,
                                                      P_time,
+                                                     neighbors_order,
+                                                     reduction,
+                                                     Graph::g->is_sparse() ? "sparse"
+                                                                           : "dense",
+                                                     relabel,
+                                                     conflicts_layout,
+                                                     nb_threads,
+                                                     parallelization,
+                                                     nb_simulation_threads,
+                                                     transposition_table,
+                                                     tree_memory,
+                                                     checkpoint,
+                                                     checkpoint_period,
+                                                     resume,
                                                      output_directory);
 
         // the method can't be created before the parameters
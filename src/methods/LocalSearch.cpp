@@ -40,29 +40,49 @@ void LocalSearch::run() {
         _best_solution.line_csv());
 }
 
-local_search_ptr get_local_search_fct(const std::string &local_search) {
-    if (local_search == "none")
-        return none_ls;
+/**
+ * @brief Get the local search instantiated for the problem
+ *
+ * @tparam Problem ProblemWVCP or ProblemGCP
+ * @param local_search name of the local search
+ * @return local_search_ptr function local search, nullptr if the local search is not
+ * templated on the problem
+ */
+template <typename Problem>
+local_search_ptr get_problem_local_search_fct(const std::string &local_search) {
     if (local_search == "hill_climbing")
-        return hill_climbing_one_move;
+        return hill_climbing_one_move<Problem>;
     if (local_search == "tabu_col")
-        return tabu_col;
+        return tabu_col<Problem>;
     if (local_search == "tabu_col_neighborhood")
-        return tabu_col_neighborhood;
+        return tabu_col_neighborhood<Problem>;
     if (local_search == "random_walk_gcp")
-        return random_walk_gcp;
+        return random_walk_gcp<Problem>;
     if (local_search == "partial_col")
-        return partial_col;
+        return partial_col<Problem>;
     if (local_search == "tabu_weight")
-        return tabu_weight;
+        return tabu_weight<Problem>;
     if (local_search == "tabu_weight_neighborhood")
-        return tabu_weight_neighborhood;
+        return tabu_weight_neighborhood<Problem>;
     if (local_search == "random_walk_wvcp")
-        return random_walk_wvcp;
+        return random_walk_wvcp<Problem>;
     if (local_search == "afisa")
-        return afisa;
+        return afisa<Problem>;
     if (local_search == "afisa_original")
-        return afisa_original;
+        return afisa_original<Problem>;
+    return nullptr;
+}
+
+local_search_ptr get_local_search_fct(const std::string &local_search) {
+    // the instantiation is chosen once, when the local searches are selected
+    const local_search_ptr problem_local_search =
+        Solution::weighted ? get_problem_local_search_fct<ProblemWVCP>(local_search)
+                           : get_problem_local_search_fct<ProblemGCP>(local_search);
+    if (problem_local_search) {
+        return problem_local_search;
+    }
+    if (local_search == "none")
+        return none_ls;
     if (local_search == "redls")
         return redls;
     if (local_search == "redls_freeze")
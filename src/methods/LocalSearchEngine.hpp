@@ -0,0 +1,327 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+
+#include "../representation/MoveCache.hpp"
+#include "../representation/Parameters.hpp"
+#include "../representation/Solution.hpp"
+#include "../representation/enum_types.hpp"
+#include "../utils/random_generator.hpp"
+#include "../utils/utils.hpp"
+
+/**
+ * @brief Loop of the one move local searches, its parts are given as policies so each
+ * local search is a bundle of policies resolved at compile time (as ProblemPolicy.hpp)
+ *
+ * Each turn, the neighborhood draws a move, the move is applied, the tabu policy gives
+ * the tenure of the moved vertex and its old color, then the acceptance policy updates
+ * the best solution. The evaluation of the moves and the aspiration criterion are
+ * parameters of the neighborhood as its moves are maintained incrementally. The
+ * perturbations of AFISA are the choice of the tabu policy
+ *
+ * Neighborhood :
+ * - bool select(const long turn, const int aspiration, Coloration &move) : draw one of
+ * the best moves, a tabu move reaching a legal score lower than aspiration is allowed,
+ * false if there is no move
+ * - int move(const Coloration &move) : apply the move and return the old color
+ * - void set_tabu(const int vertex, const int color, const long turn, const long tenure)
+ *
+ * Tabu :
+ * - static constexpr bool enabled : false if no move is tabu
+ * - long tenure(const long turn) : number of turns the move back is tabu
+ *
+ * Acceptance :
+ * - bool finished() const : true to stop before the next turn
+ * - int aspiration() const : score to reach to take a tabu move
+ * - void no_move() : the neighborhood has no move this turn
+ * - void update(const long turn) : after a move
+ *
+ * @tparam Neighborhood moves of the search
+ * @tparam Tabu tenure of the moves
+ * @tparam Acceptance best solution and end of the search
+ */
+template <typename Neighborhood, typename Tabu, typename Acceptance>
+class LocalSearchEngine {
+  private:
+    /** @brief Moves of the search*/
+    Neighborhood _neighborhood;
+    /** @brief Tenure of the moves*/
+    Tabu _tabu;
+    /** @brief Best solution and end of the search*/
+    Acceptance _acceptance;
+
+  public:
+    LocalSearchEngine(Neighborhood neighborhood, Tabu tabu, Acceptance acceptance)
+        : _neighborhood(std::move(neighborhood)),
+          _tabu(std::move(tabu)),
+          _acceptance(std::move(acceptance)) {
+    }
+
+    /**
+     * @brief Run the search
+     *
+     * @param max_turns maximum number of turns
+     * @param max_time time limit of the search
+     * @return long number of turns done
+     */
+    long run(const long max_turns,
+             const std::chrono::high_resolution_clock::time_point &max_time) {
+        long turn = 0;
+        while (not Parameters::p->time_limit_reached_sub_method(max_time) and
+               turn < max_turns and not _acceptance.finished()) {
+            ++turn;
+            Coloration move{};
+            if (not _neighborhood.select(turn, _acceptance.aspiration(), move)) {
+                _acceptance.no_move();
+                continue;
+            }
+            const int old_color = _neighborhood.move(move);
+            if constexpr (Tabu::enabled) {
+                _neighborhood.set_tabu(move.vertex, old_color, turn, _tabu.tenure(turn));
+            }
+            _acceptance.update(turn);
+        }
+        return turn;
+    }
+
+    /**
+     * @brief Return the acceptance policy
+     */
+    [[nodiscard]] const Acceptance &acceptance() const {
+        return _acceptance;
+    }
+};
+
+/**
+ * @brief Neighborhood of the moves of a MoveCache
+ *
+ * @tparam Problem ProblemWVCP or ProblemGCP
+ * @tparam improving_only true to select only the moves lowering the score
+ */
+template <typename Problem, bool improving_only> class CachedNeighborhood {
+  private:
+    /** @brief Moves of the solution*/
+    MoveCache &_cache;
+
+  public:
+    explicit CachedNeighborhood(MoveCache &cache) : _cache(cache) {
+    }
+
+    [[nodiscard]] bool select(const long turn, const int aspiration, Coloration &move) {
+        if constexpr (improving_only) {
+            if (_cache.best_delta<Problem>(turn) >= 0) {
+                return false;
+            }
+        }
+        return _cache.best_move<Problem>(turn, aspiration, move);
+    }
+
+    int move(const Coloration &move) {
+        return _cache.move<Problem>(move.vertex, move.color);
+    }
+
+    void set_tabu(const int vertex, const int color, const long turn, const long tenure) {
+        _cache.set_tabu(vertex, color, turn + tenure);
+    }
+};
+
+/**
+ * @brief No move is tabu
+ */
+struct NoTabu {
+    static constexpr bool enabled = false;
+
+    [[nodiscard]] long tenure(const long) const {
+        return 0;
+    }
+};
+
+/**
+ * @brief The move back is tabu for the number of non empty colors (tabu_weight)
+ */
+struct TabuNbColors {
+    static constexpr bool enabled = true;
+    /** @brief The solution searched*/
+    const Solution &solution;
+
+    [[nodiscard]] long tenure(const long) const {
+        return solution.nb_non_empty_colors();
+    }
+};
+
+/**
+ * @brief The move back is tabu for a minimum number of turns plus a random number in
+ * [0, 10] (AFISA)
+ */
+struct TabuRandom {
+    static constexpr bool enabled = true;
+    /** @brief Minimum tenure*/
+    const long tenure_min;
+    /** @brief Random part of the tenure*/
+    std::uniform_int_distribution<int> distribution{0, 10};
+
+    [[nodiscard]] long tenure(const long) {
+        return tenure_min + distribution(rd::generator);
+    }
+};
+
+/**
+ * @brief The move back is tabu until the end of the search (perturbation of AFISA)
+ */
+struct TabuUntilEnd {
+    static constexpr bool enabled = true;
+    /** @brief First turn where the moves are not tabu*/
+    const long end_turn;
+
+    [[nodiscard]] long tenure(const long turn) const {
+        return end_turn - turn;
+    }
+};
+
+/**
+ * @brief Keep the best solution of lowest score, the moves are drawn among the legal
+ * solutions (tabu_weight)
+ */
+struct BestScoreAcceptance {
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief Best solution found*/
+    SolutionSnapshot &best_snapshot;
+    /** @brief True if print csv line each time new best scores is found*/
+    const bool verbose;
+    /** @brief Time of the best solution*/
+    int64_t best_time{0};
+
+    [[nodiscard]] bool finished() const {
+        return best_snapshot.score_wvcp() == Parameters::p->target;
+    }
+
+    [[nodiscard]] int aspiration() const {
+        return best_snapshot.score_wvcp();
+    }
+
+    void no_move() {
+    }
+
+    void update(const long turn) {
+        if (solution.score_wvcp() < best_snapshot.score_wvcp()) {
+            best_snapshot.save(solution);
+            if (verbose) {
+                best_time = Parameters::p->elapsed_time(
+                    std::chrono::high_resolution_clock::now());
+                print_result_ls(best_time, solution, turn);
+            }
+        } else if (solution.score_wvcp() == best_snapshot.score_wvcp()) {
+            best_snapshot.save(solution);
+        }
+    }
+};
+
+/**
+ * @brief Keep the best solution of lowest score plus penalty coefficient times the
+ * penalty, a tabu move is taken if it reaches a legal solution better than the best
+ * legal one (AFISA)
+ */
+struct PenalizedScoreAcceptance {
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief Best legal solution, for the aspiration*/
+    const Solution &best_solution;
+    /** @brief Best solution found (may not be legal)*/
+    SolutionSnapshot &best_afisa_sol;
+    /** @brief Coefficient of the penalty*/
+    const int penalty_coeff;
+    /** @brief True if a move reached the target*/
+    bool target_reached{false};
+
+    [[nodiscard]] bool finished() const {
+        return target_reached;
+    }
+
+    [[nodiscard]] int aspiration() const {
+        return best_solution.score_wvcp();
+    }
+
+    void no_move() {
+    }
+
+    void update(const long) {
+        if ((solution.score_wvcp() + penalty_coeff * solution.penalty()) <
+            (best_afisa_sol.score_wvcp() + penalty_coeff * best_afisa_sol.penalty())) {
+            best_afisa_sol.save(solution);
+        }
+        target_reached = solution.score_wvcp() == Parameters::p->target;
+    }
+};
+
+/**
+ * @brief Stop at the first solution without improving move (hill climbing)
+ */
+struct ImprovingAcceptance {
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief True if print csv line after each move*/
+    const bool verbose;
+    /** @brief True if no move improves the solution*/
+    bool local_optimum{false};
+
+    [[nodiscard]] bool finished() const {
+        return local_optimum or solution.score_wvcp() == Parameters::p->target;
+    }
+
+    [[nodiscard]] int aspiration() const {
+        return std::numeric_limits<int>::min();
+    }
+
+    void no_move() {
+        local_optimum = true;
+    }
+
+    void update(const long turn) {
+        if (verbose) {
+            print_result_ls(
+                Parameters::p->elapsed_time(std::chrono::high_resolution_clock::now()),
+                solution,
+                turn);
+        }
+    }
+};
+
+/**
+ * @brief Run the search with the tabu policy of the perturbation of AFISA
+ *
+ * @param perturbation no_perturbation for the tabu policy, unlimited for the moves tabu
+ * until the end of the search, no_tabu for no tabu move
+ * @param neighborhood moves of the search
+ * @param tabu tenure of the moves without perturbation
+ * @param acceptance best solution and end of the search
+ * @param turns number of turns of the search
+ * @param max_time time limit of the search
+ */
+template <typename Neighborhood, typename Tabu, typename Acceptance>
+void run_perturbation(const Perturbation perturbation,
+                      Neighborhood neighborhood,
+                      Tabu tabu,
+                      Acceptance acceptance,
+                      const long turns,
+                      const std::chrono::high_resolution_clock::time_point &max_time) {
+    switch (perturbation) {
+    case Perturbation::no_perturbation:
+        LocalSearchEngine(std::move(neighborhood), std::move(tabu), std::move(acceptance))
+            .run(turns, max_time);
+        break;
+    case Perturbation::unlimited:
+        LocalSearchEngine(
+            std::move(neighborhood), TabuUntilEnd{turns + 1}, std::move(acceptance))
+            .run(turns, max_time);
+        break;
+    case Perturbation::no_tabu:
+        LocalSearchEngine(std::move(neighborhood), NoTabu{}, std::move(acceptance))
+            .run(turns, max_time);
+        break;
+    }
+}
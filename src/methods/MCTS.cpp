@@ -3,6 +3,10 @@
 #include <cassert>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
 #include <utility>
 
 #include "../utils/random_generator.hpp"
@@ -14,27 +18,24 @@
 #pragma GCC diagnostic pop
 
 MCTS::MCTS()
-    : _root_node(nullptr),
-      _current_node(_root_node),
-      _base_solution(),
-      _best_solution(),
-      _current_solution(_base_solution),
-      _turn(0),
+    : _best_solution(),
+      _best_score(0),
       _initialization(get_initialization_fct(Parameters::p->initialization)),
       _simulation(get_simulation_fct(Parameters::p->simulation)) {
+    // the checkpoint is checked before printing anything
+    BinaryReader checkpoint;
+    if (not Parameters::p->resume.empty()) {
+        open_checkpoint(checkpoint, Parameters::p->resume);
+    }
+
     greedy_random(_best_solution);
     _t_best = std::chrono::high_resolution_clock::now();
+    _best_score = _best_solution.score_wvcp();
     Solution::best_score_wvcp = _best_solution.score_wvcp();
 
     if (Parameters::p->use_target and Parameters::p->target > 0) {
         Solution::best_score_wvcp = Parameters::p->target;
     }
-    // Creation of the base solution and root node
-    const auto next_moves = next_possible_moves(_base_solution);
-    assert(next_moves.size() == 1);
-    apply_action(_base_solution, next_moves[0]);
-    const auto next_possible_actions = next_possible_moves(_base_solution);
-    _root_node = std::make_shared<Node>(nullptr, next_moves[0], next_possible_actions);
 
     fmt::print(Parameters::p->output, "{}", header_csv());
 
@@ -53,55 +54,316 @@ MCTS::MCTS()
     }
 
     if (Parameters::p->simulation != "no_ls") {
-        // init the adaptive helper
-        _adaptive_helper =
-            get_adaptive_helper(Parameters::p->adaptive,
-                                static_cast<int>(Parameters::p->local_search.size()));
         fmt::print(Parameters::p->output_tbt, "#operators\n");
         fmt::print(Parameters::p->output_tbt, "#{}\n", operators_str);
         fmt::print(Parameters::p->output_tbt,
                    "time,turn,proba,selected,score_pre_ls,score_post_ls\n");
     } else {
         _local_search.clear();
-        _adaptive_helper = nullptr;
+    }
+
+    // Creation of the tree of each thread or of the tree shared by the threads
+    const bool shared_tree = Parameters::p->parallelization == "tree";
+    for (int thread = 0; thread < Parameters::p->nb_threads; ++thread) {
+        const MCTSWorker *tree_owner =
+            (shared_tree and thread > 0) ? _workers[0].get() : nullptr;
+        _workers.emplace_back(std::make_unique<MCTSWorker>(*this, tree_owner));
+    }
+
+    if (not Parameters::p->resume.empty()) {
+        resume(checkpoint, Parameters::p->resume);
     }
 }
 
 MCTS::~MCTS() {
-    _current_node = nullptr;
-    _root_node->clean_graph(0);
-    _root_node = nullptr;
+    _workers.clear();
 }
 
-bool MCTS::stop_condition() const {
-    return (_turn < Parameters::p->nb_max_iterations) and
+[[nodiscard]] long MCTS::nb_turns() const {
+    long nb_turns = 0;
+    for (const auto &worker : _workers) {
+        nb_turns += worker->turn();
+    }
+    return nb_turns;
+}
+
+void MCTS::run() {
+    // the first tree is searched with the random generator seeded in main, the other
+    // threads seed their generator from the rand seed and their number
+    if (not _resumed) {
+        _workers[0]->seed(rd::generator);
+        for (std::size_t id = 1; id < _workers.size(); ++id) {
+            std::seed_seq seed{Parameters::p->rand_seed, static_cast<int>(id)};
+            _workers[id]->seed(std::mt19937(seed));
+        }
+    }
+    // the threads stop at the end of each period to write a checkpoint
+    do {
+        _period_end = Parameters::p->checkpoint.empty()
+                          ? std::chrono::high_resolution_clock::time_point::max()
+                          : std::chrono::high_resolution_clock::now() +
+                                std::chrono::seconds(Parameters::p->checkpoint_period);
+        std::vector<std::thread> threads;
+        for (std::size_t id = 1; id < _workers.size(); ++id) {
+            threads.emplace_back([this, id]() { _workers[id]->run(); });
+        }
+        _workers[0]->run();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (not Parameters::p->checkpoint.empty()) {
+            save_checkpoint();
+        }
+    } while (stop_condition());
+    fmt::print(Parameters::p->output, "{}", line_csv());
+}
+
+[[nodiscard]] bool MCTS::stop_condition() const {
+    return (nb_turns() < Parameters::p->nb_max_iterations) and
            (not Parameters::p->time_limit_reached()) and
            not(Parameters::p->objective == "reached" and
-               (_best_solution.score_wvcp() <= Parameters::p->target)) and
-           not _root_node->fully_explored();
+               (_best_score <= Parameters::p->target)) and
+           not _fully_explored;
 }
 
-void MCTS::run() {
-    SimulationHelper helper;
+namespace {
+/** @brief First value of a checkpoint file*/
+const std::string checkpoint_magic = "gc_wvcp_mcts_checkpoint";
+/** @brief Version of the checkpoint format*/
+constexpr int checkpoint_version = 2;
+} // namespace
+
+void MCTS::save_checkpoint() const {
+    BinaryWriter writer;
+    writer.write_string(checkpoint_magic);
+    writer.write(checkpoint_version);
+    // the checkpoint can only be resumed with the same instance, vertex ids and threads
+    writer.write_string(Parameters::p->problem);
+    writer.write_string(Parameters::p->neighbors_order);
+    writer.write_string(Parameters::p->reduction);
+    writer.write_string(Parameters::p->graph_mode);
+    writer.write_string(Parameters::p->relabel);
+    writer.write(Graph::g->nb_vertices);
+    writer.write(Graph::g->nb_edges);
+    writer.write_vector(
+        std::vector<int>(Graph::g->weights.begin(), Graph::g->weights.end()));
+    writer.write_vector(
+        std::vector<int>(Graph::g->original_ids.begin(), Graph::g->original_ids.end()));
+    writer.write(Parameters::p->nb_threads);
+    writer.write_string(Parameters::p->parallelization);
+
+    writer.write_vector(_best_solution.colors());
+    writer.write(_best_score.load());
+    writer.write(_fully_explored.load());
+    writer.write(Node::get_raw_total_nodes());
+    writer.write(Node::get_height());
+    // the threads share the first tree with the tree parallelization
+    const bool shared_tree = Parameters::p->parallelization == "tree";
+    for (std::size_t id = 0; id < _workers.size(); ++id) {
+        _workers[id]->save(writer, id == 0 or not shared_tree);
+    }
+    if (not writer.to_file(Parameters::p->checkpoint)) {
+        fmt::print(
+            stderr, "error: can't write checkpoint {}\n", Parameters::p->checkpoint);
+    }
+}
+
+void MCTS::open_checkpoint(BinaryReader &reader, const std::string &file_name) {
+    if (not reader.from_file(file_name)) {
+        fmt::print(stderr, "error: can't read checkpoint {}\n", file_name);
+        exit(1);
+    }
+    if (reader.read_string() != checkpoint_magic or
+        reader.read<int>() != checkpoint_version or
+        reader.read_string() != Parameters::p->problem or
+        reader.read_string() != Parameters::p->neighbors_order or
+        reader.read_string() != Parameters::p->reduction or
+        reader.read_string() != Parameters::p->graph_mode or
+        reader.read_string() != Parameters::p->relabel or
+        reader.read<int>() != Graph::g->nb_vertices or
+        reader.read<int>() != Graph::g->nb_edges or
+        reader.read_vector<int>() != std::vector<int>(Graph::g->weights.begin(),
+                                                      Graph::g->weights.end()) or
+        reader.read_vector<int>() != std::vector<int>(Graph::g->original_ids.begin(),
+                                                      Graph::g->original_ids.end()) or
+        reader.read<int>() != Parameters::p->nb_threads or
+        reader.read_string() != Parameters::p->parallelization) {
+        fmt::print(stderr,
+                   "error: checkpoint {} doesn't match the instance, the problem, the "
+                   "graph options, the number of threads or the parallelization\n",
+                   file_name);
+        exit(1);
+    }
+}
+
+void MCTS::resume(BinaryReader &reader, const std::string &file_name) {
+
+    // the best solution is rebuilt from the colors of its vertices
+    const auto colors = reader.read_vector<int>();
+    const int best_score = reader.read<int>();
+    Solution best_solution;
+    if (colors.size() != static_cast<std::size_t>(Graph::g->nb_vertices)) {
+        reader.fail();
+    }
+    for (int vertex = 0; vertex < Graph::g->nb_vertices and not reader.failed();
+         ++vertex) {
+        const int color = colors[static_cast<std::size_t>(vertex)];
+        if (color < 0 or color >= Graph::g->nb_vertices) {
+            reader.fail();
+            break;
+        }
+        best_solution.add_to_color(vertex, color);
+    }
+    _fully_explored = reader.read<bool>();
+    const long total_nodes = reader.read<long>();
+    const int height = reader.read<int>();
+    const bool shared_tree = Parameters::p->parallelization == "tree";
+    for (std::size_t id = 0; id < _workers.size(); ++id) {
+        _workers[id]->load(reader, id == 0 or not shared_tree);
+        if (shared_tree and id > 0) {
+            _workers[id]->share_tree(*_workers[0]);
+        }
+    }
+    if (reader.failed() or best_solution.score_wvcp() != best_score) {
+        fmt::print(stderr, "error: checkpoint {} is corrupted\n", file_name);
+        exit(1);
+    }
+
+    _best_solution = best_solution;
+    _best_score = best_score;
+    _t_best = std::chrono::high_resolution_clock::now();
+    Solution::best_score_wvcp = best_score;
+    if (Parameters::p->use_target and Parameters::p->target > 0) {
+        Solution::best_score_wvcp = Parameters::p->target;
+    }
+    // the nodes read have been counted as created
+    Node::resume_counters(total_nodes, height);
+    _resumed = true;
+    fmt::print(Parameters::p->output, "{}", line_csv());
+}
+
+void MCTS::update_best_solution(const Solution &solution, const int depth) {
+    const int score_wvcp = solution.score_wvcp();
+    // most of the solutions are worse, no need to lock
+    if (score_wvcp >= _best_score) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(_best_mutex);
+    if (score_wvcp >= _best_solution.score_wvcp()) {
+        return;
+    }
+    _t_best = std::chrono::high_resolution_clock::now();
+    _best_solution = solution;
+    _best_score = score_wvcp;
+    int best_score_wvcp = Solution::best_score_wvcp;
+    while (score_wvcp < best_score_wvcp and
+           not Solution::best_score_wvcp.compare_exchange_weak(best_score_wvcp,
+                                                               score_wvcp)) {
+    }
+    fmt::print(Parameters::p->output, "{}", line_csv(depth));
+}
+
+[[nodiscard]] const std::string MCTS::header_csv() const {
+    return fmt::format("turn,time,depth,nb total node,nb "
+                       "current node,height,tree memory kb,peak tree memory kb,{}\n",
+                       Solution::header_csv);
+}
+
+[[nodiscard]] const std::string MCTS::line_csv() const {
+    const std::lock_guard<std::mutex> lock(_best_mutex);
+    return line_csv(_workers[0]->root_depth());
+}
+
+[[nodiscard]] const std::string MCTS::line_csv(const int depth) const {
+    // the threads share the first tree with the tree parallelization
+    const std::size_t nb_trees =
+        Parameters::p->parallelization == "tree" ? 1 : _workers.size();
+    std::size_t tree_memory = 0;
+    std::size_t peak_tree_memory = 0;
+    for (std::size_t tree = 0; tree < nb_trees; ++tree) {
+        tree_memory += _workers[tree]->tree_memory();
+        peak_tree_memory += _workers[tree]->peak_tree_memory();
+    }
+    return fmt::format("{},{},{},{},{},{},{},{},{}\n",
+                       nb_turns(),
+                       Parameters::p->elapsed_time(_t_best),
+                       depth,
+                       Node::get_total_nodes(),
+                       Node::get_nb_current_nodes(),
+                       Node::get_height(),
+                       tree_memory / 1024,
+                       peak_tree_memory / 1024,
+                       _best_solution.line_csv());
+}
+
+MCTSWorker::MCTSWorker(MCTS &mcts, const MCTSWorker *tree_owner)
+    : _mcts(mcts),
+      _tree(nullptr),
+      _transpositions(nullptr),
+      _current_node(0),
+      _base_solution(),
+      _current_solution(_base_solution) {
+    // Creation of the base solution and root node
+    const auto next_moves = next_possible_moves(_base_solution);
+    assert(next_moves.size() == 1);
+    apply_action(_base_solution, next_moves[0]);
+    if (tree_owner) {
+        _tree = tree_owner->_tree;
+        _transpositions = tree_owner->_transpositions;
+    } else {
+        const auto next_possible_actions = next_possible_moves(_base_solution);
+        _tree = std::make_shared<Tree>(next_moves[0], next_possible_actions);
+        if (Parameters::p->transposition_table > 0) {
+            _transpositions =
+                std::make_shared<TranspositionTable>(Parameters::p->transposition_table);
+        }
+    }
+
+    if (Parameters::p->simulation != "no_ls") {
+        // init the adaptive helper
+        _adaptive_helper =
+            get_adaptive_helper(Parameters::p->adaptive,
+                                static_cast<int>(Parameters::p->local_search.size()));
+    }
+}
+
+bool MCTSWorker::stop_condition() const {
+    return _mcts.stop_condition() and not _tree->fully_explored(_tree->root()) and
+           std::chrono::high_resolution_clock::now() < _mcts._period_end;
+}
+
+void MCTSWorker::run() {
+    rd::generator = _generator;
     int operator_number = 0;
     auto *cast_nn = dynamic_cast<AdaptiveHelper_neural_net *>(_adaptive_helper.get());
+    // the local searches of several leaves can run at the same time
+    std::unique_ptr<SimulationPool> pool{};
+    if (Parameters::p->nb_simulation_threads > 1 and not _mcts._local_search.empty()) {
+        pool = std::make_unique<SimulationPool>(_mcts._local_search,
+                                                Parameters::p->nb_simulation_threads);
+    }
+
+    // each turn starts from the base solution by undoing the moves of the previous turn
+    _current_solution = _base_solution;
+    _base_checkpoint = _current_solution.checkpoint();
 
     while (stop_condition()) {
         ++_turn;
 
-        _current_node = _root_node;
-        _current_solution = _base_solution;
+        start_turn();
 
         selection();
 
         expansion();
 
-        // simulation
-        _initialization(_current_solution);
+        // simulation, its moves are undone before the next lookup in the table
+        _current_solution.pause_transposition_key();
+        _mcts._initialization(_current_solution);
         const int score_before_ls = _current_solution.score_wvcp();
 
         // local search or not and adaptive selection
-        const bool use_local_search = _simulation(_current_solution, helper);
+        const bool use_local_search =
+            _mcts._simulation(_current_solution, _simulation_helper);
         if (use_local_search) {
             // ask the adaptive helper which local search to use
             if (cast_nn) {
@@ -109,88 +371,212 @@ void MCTS::run() {
             } else {
                 operator_number = _adaptive_helper->get_operator();
             }
-            const auto ls = _local_search[operator_number];
+            if (pool) {
+                // the turn ends when the local search is done, the current solution is
+                // still the leaf so it is rolled back at the next turn
+                pool->submit(Simulation{
+                    _current_solution, std::move(_path), operator_number, score_before_ls});
+                _path.clear();
+                if (pool->nb_pending() == pool->nb_threads()) {
+                    end_simulation(pool->wait_result());
+                }
+                continue;
+            }
+            const auto ls = _mcts._local_search[operator_number];
             ls(_current_solution, false);
+            update_adaptive_helper(operator_number, score_before_ls, _current_solution);
+        }
 
-            _adaptive_helper->update_obtained_solution(operator_number,
-                                                       _current_solution.score_wvcp());
-            _adaptive_helper->update_helper();
-            fmt::print(
-                Parameters::p->output_tbt,
-                "{},{},{},{},{},{}\n",
-                Parameters::p->elapsed_time(std::chrono::high_resolution_clock::now()),
-                _turn,
-                _adaptive_helper->to_str_proba(),
-                operator_number,
-                score_before_ls,
-                _current_solution.score_wvcp());
-
-            _adaptive_helper->increment_turn();
-        }
-
-        const int score_wvcp = _current_solution.score_wvcp();
-        // update
-        _current_node->update(score_wvcp);
-        // update and print best score
-        if (_best_solution.score_wvcp() > score_wvcp) {
-            _t_best = std::chrono::high_resolution_clock::now();
-            _best_solution = _current_solution;
-            if (Solution::best_score_wvcp > score_wvcp)
-                Solution::best_score_wvcp = score_wvcp;
-            fmt::print(Parameters::p->output, "{}", line_csv());
-            _current_node = nullptr;
-            _root_node->clean_graph(_best_solution.score_wvcp());
-        }
-        _current_node = nullptr;
-    }
-    _current_node = _root_node;
-    fmt::print(Parameters::p->output, "{}", line_csv());
-    _current_node = nullptr;
-}
-
-void MCTS::selection() {
-    while (not _current_node->terminal()) {
-        double max_score = std::numeric_limits<double>::min();
-        std::vector<std::shared_ptr<Node>> next_nodes;
-        for (const auto &node : _current_node->children_nodes()) {
-            if (node->score_ucb() > max_score) {
-                max_score = node->score_ucb();
-                next_nodes = {node};
-            } else if (node->score_ucb() == max_score) {
-                next_nodes.push_back(node);
-            }
+        end_turn(_current_solution);
+    }
+    // the turns still in the pool
+    while (pool and pool->nb_pending() > 0) {
+        end_simulation(pool->wait_result());
+    }
+    // the tree is fully explored, the other threads can stop
+    if (_tree->fully_explored(_tree->root())) {
+        _mcts._fully_explored = true;
+    }
+    _generator = rd::generator;
+}
+
+void MCTSWorker::seed(const std::mt19937 &generator) {
+    _generator = generator;
+}
+
+void MCTSWorker::share_tree(const MCTSWorker &tree_owner) {
+    _tree = tree_owner._tree;
+    _transpositions = tree_owner._transpositions;
+}
+
+void MCTSWorker::save(BinaryWriter &writer, const bool with_tree) const {
+    writer.write(turn());
+    std::ostringstream generator;
+    generator << _generator;
+    writer.write_string(generator.str());
+    _simulation_helper.save(writer);
+    writer.write(static_cast<uint8_t>(_adaptive_helper != nullptr));
+    if (_adaptive_helper) {
+        _adaptive_helper->save(writer);
+    }
+    if (with_tree) {
+        _tree->save(writer);
+    }
+}
+
+void MCTSWorker::load(BinaryReader &reader, const bool with_tree) {
+    _turn = reader.read<long>();
+    std::istringstream generator(reader.read_string());
+    generator >> _generator;
+    if (generator.fail()) {
+        reader.fail();
+    }
+    _simulation_helper.load(reader);
+    if (reader.read<uint8_t>() != static_cast<uint8_t>(_adaptive_helper != nullptr)) {
+        reader.fail();
+    } else if (_adaptive_helper) {
+        _adaptive_helper->load(reader);
+    }
+    if (with_tree and not reader.failed()) {
+        _tree = std::make_shared<Tree>(reader);
+        // the table starts empty, the partial solutions of the tree are not skipped
+        if (Parameters::p->transposition_table > 0) {
+            _transpositions =
+                std::make_shared<TranspositionTable>(Parameters::p->transposition_table);
         }
-        _current_node = rd::choice(next_nodes);
-        apply_action(_current_solution, _current_node->move());
     }
 }
 
-void MCTS::expansion() {
-    const Action next_move = _current_node->next_child();
-    apply_action(_current_solution, next_move);
+void MCTSWorker::start_turn() {
+    _current_node = _tree->root();
+    _tree->enter_root();
+    _path.push_back(_current_node);
+    if (not _current_solution.rollback(_base_checkpoint)) {
+        // the solution has been assigned during the turn
+        _current_solution = _base_solution;
+        _base_checkpoint = _current_solution.checkpoint();
+    }
+}
+
+void MCTSWorker::selection() {
+    while (not _tree->terminal(_current_node)) {
+        // the chosen child may be freed if the selection fails, it is kept apart
+        NodeId child{};
+        if (_tree->select_child(_current_node, child)) {
+            _current_node = child;
+            _path.push_back(_current_node);
+            apply_action(_current_solution, _tree->move(_current_node));
+            continue;
+        }
+        if (_path.size() == 1 or not _tree->fully_explored(_current_node)) {
+            // the tree is fully explored or the children are being expanded by the other
+            // threads
+            return;
+        }
+        // the pruning left nothing under the node, the turn starts again from the root
+        _tree->abandon(_path);
+        _path.clear();
+        start_turn();
+    }
+}
+
+void MCTSWorker::expansion() {
+    Action next_move{};
+    std::shared_lock<std::shared_mutex> lock{};
+    if (_transpositions) {
+        lock = std::shared_lock<std::shared_mutex>(_transpositions->expansion_mutex());
+    }
+    const std::size_t checkpoint = _current_solution.checkpoint();
+    while (true) {
+        if (not _tree->next_child(_current_node, next_move)) {
+            // the last move has been taken by another thread or skipped
+            return;
+        }
+        apply_action(_current_solution, next_move);
+        if (not _transpositions or not _transpositions->dominated(_current_solution)) {
+            break;
+        }
+        // an equivalent partial solution with a lower or equal score is in the tree
+        _tree->skip_child(_current_node);
+        _current_solution.rollback(checkpoint);
+    }
     const auto next_possible_actions = next_possible_moves(_current_solution);
-    if (not next_possible_actions.empty()) {
-        _current_node =
-            std::make_shared<Node>(_current_node.get(), next_move, next_possible_actions);
-        _current_node->add_child_to_parent(_current_node);
+    if (next_possible_actions.empty()) {
+        _tree->skip_child(_current_node);
+        return;
     }
+    _current_node = _tree->add_child(_current_node, next_move, next_possible_actions);
+    _path.push_back(_current_node);
 }
 
-[[nodiscard]] const std::string MCTS::header_csv() const {
-    return fmt::format("turn,time,depth,nb total node,nb "
-                       "current node,height,{}\n",
-                       Solution::header_csv);
+void MCTSWorker::update_adaptive_helper(const int operator_number,
+                                        const int score_before_ls,
+                                        const Solution &solution) {
+    _adaptive_helper->update_obtained_solution(operator_number, solution.score_wvcp());
+    _adaptive_helper->update_helper();
+    fmt::print(Parameters::p->output_tbt,
+               "{},{},{},{},{},{}\n",
+               Parameters::p->elapsed_time(std::chrono::high_resolution_clock::now()),
+               _mcts.nb_turns(),
+               _adaptive_helper->to_str_proba(),
+               operator_number,
+               score_before_ls,
+               solution.score_wvcp());
+
+    _adaptive_helper->increment_turn();
 }
 
-[[nodiscard]] const std::string MCTS::line_csv() const {
-    return fmt::format("{},{},{},{},{},{},{}\n",
-                       _turn,
-                       Parameters::p->elapsed_time(_t_best),
-                       _current_node->get_depth(),
-                       Node::get_total_nodes(),
-                       Node::get_nb_current_nodes(),
-                       Node::get_height(),
-                       _best_solution.line_csv());
+void MCTSWorker::end_turn(const Solution &solution) {
+    const int depth = _tree->get_depth(_path.back());
+    // update
+    backpropagation(solution.score_wvcp());
+    // update and print best score, the tree is pruned with the best score found by any
+    // thread
+    _mcts.update_best_solution(solution, depth);
+    _tree->prune(_mcts._best_score);
+    // the tree goes down to 3/4 of its budget so the evictions are not too frequent
+    const std::size_t budget = static_cast<std::size_t>(Parameters::p->tree_memory) << 20;
+    if (budget == 0 or _tree->memory() <= budget) {
+        return;
+    }
+    if (not _transpositions) {
+        _tree->evict(budget / 4 * 3);
+        return;
+    }
+    // the evicted partial solutions must be reachable again, no thread expands the tree
+    // before the table is cleared
+    const std::unique_lock<std::shared_mutex> lock(_transpositions->expansion_mutex());
+    if (_tree->evict(budget / 4 * 3)) {
+        _transpositions->clear();
+    }
+}
+
+void MCTSWorker::end_simulation(Simulation &&simulation) {
+    update_adaptive_helper(
+        simulation.operator_number, simulation.score_before_ls, simulation.solution);
+    _path = std::move(simulation.path);
+    end_turn(simulation.solution);
+}
+
+void MCTSWorker::backpropagation(const int score) {
+    _tree->update(_path, score);
+    _path.clear();
+}
+
+[[nodiscard]] long MCTSWorker::turn() const {
+    return _turn.load(std::memory_order_relaxed);
+}
+
+[[nodiscard]] std::size_t MCTSWorker::tree_memory() const {
+    return _tree->memory();
+}
+
+[[nodiscard]] std::size_t MCTSWorker::peak_tree_memory() const {
+    return _tree->peak_memory();
+}
+
+[[nodiscard]] int MCTSWorker::root_depth() const {
+    return _tree->get_depth(_tree->root());
 }
 
 std::vector<Action> next_possible_moves(const Solution &solution) {
@@ -202,7 +588,7 @@ std::vector<Action> next_possible_moves(const Solution &solution) {
 
     int nb_colors = 0;
     // each vertex need at most |N(v)| + 1 colors
-    int degree_p1 = static_cast<int>(Graph::g->neighborhood[next_vertex].size()) + 1;
+    int degree_p1 = Graph::g->degree(next_vertex) + 1;
 
     for (const auto color : solution.non_empty_colors()) {
         ++nb_colors;
@@ -223,7 +609,9 @@ std::vector<Action> next_possible_moves(const Solution &solution) {
             moves.emplace_back(Action{next_vertex, -1, next_score});
         }
     }
-    std::sort(moves.begin(), moves.end(), compare_actions);
+    // the moves are taken one by one and most nodes are pruned before their last move,
+    // a heap gives the next move without sorting all of them
+    std::make_heap(moves.begin(), moves.end(), compare_actions);
     return moves;
 }
 
@@ -234,10 +622,10 @@ void apply_action(Solution &solution, const Action &action) {
     assert(solution.score_wvcp() == action.score);
 }
 
-void MCTS::to_dot(const std::string &file_name) const {
-    if ((_turn % 5) == 0) {
+void MCTSWorker::to_dot(const std::string &file_name) const {
+    if ((turn() % 5) == 0) {
         std::ofstream file(file_name);
-        file << _root_node->to_dot();
+        file << _tree->to_dot();
         file.close();
     }
 }
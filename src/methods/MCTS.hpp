@@ -1,78 +1,319 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+
 #include "../representation/Method.hpp"
-#include "../representation/Node.hpp"
+#include "../representation/Tree.hpp"
 #include "../representation/Parameters.hpp"
 #include "../representation/Solution.hpp"
+#include "../representation/TranspositionTable.hpp"
+#include "../utils/binary_stream.hpp"
 #include "LocalSearch.hpp"
 #include "SimulationHelper.hpp"
+#include "SimulationPool.hpp"
 #include "adaptive.hpp"
 
+class MCTS;
+
 /**
- * @brief Method for Monte Carlo Tree Search
+ * @brief Search of one thread of the MCTS, with its own solutions, adaptive helper and
+ * random generator. The best solution is shared through the MCTS. The tree is owned by
+ * the thread (root parallelization) or shared with the other threads (tree
+ * parallelization)
  *
  */
-class MCTS : public Method {
+class MCTSWorker {
   private:
-    /** @brief Root node of the MCTS*/
-    std::shared_ptr<Node> _root_node;
+    /** @brief MCTS sharing the best solution between the threads*/
+    MCTS &_mcts;
+    /** @brief Tree of the thread (shared by the threads with the tree parallelization)*/
+    std::shared_ptr<Tree> _tree;
+    /** @brief Partial solutions reached in the tree (shared with the tree), nullptr if
+     * the moves to equivalent partial solutions are not skipped*/
+    std::shared_ptr<TranspositionTable> _transpositions;
     /** @brief Current node*/
-    std::shared_ptr<Node> _current_node;
-    /** @brief Solution at the beginning of the tree (will be copied at each turn)*/
+    NodeId _current_node;
+    /** @brief Nodes from the root to the current node, they carry a virtual loss until
+     * the update of the turn*/
+    std::vector<NodeId> _path{};
+    /** @brief Solution at the beginning of the tree*/
     Solution _base_solution;
-    /** @brief Best found solution*/
-    Solution _best_solution;
-    /** @brief Current solution*/
+    /** @brief Current solution (brought back to the base solution at each turn with
+     * Solution::rollback)*/
     Solution _current_solution;
-    /** @brief Current turn of MCTS*/
-    long _turn{-1};
+    /** @brief Number of turns done by the thread*/
+    std::atomic<long> _turn{0};
+    /** @brief Checkpoint of the current solution at the base solution*/
+    std::size_t _base_checkpoint{0};
+    /** @brief Helper to choose the next pair of operator*/
+    std::unique_ptr<AdaptiveHelper> _adaptive_helper{};
+    /** @brief Helper to decide whether the local search is applied*/
+    SimulationHelper _simulation_helper{};
+    /** @brief Random generator of the thread, kept between the runs of the thread*/
+    std::mt19937 _generator{};
+
+  public:
+    /**
+     * @brief Construct the tree of a thread
+     *
+     * @param mcts MCTS sharing the best solution
+     * @param tree_owner thread whose tree is searched, nullptr to create a new tree
+     */
+    explicit MCTSWorker(MCTS &mcts, const MCTSWorker *tree_owner = nullptr);
+
+    /**
+     * @brief Stopping condition of the thread depending on turns, time limit, the tree
+     * fully explored or not and the end of the period between two checkpoints
+     *
+     * @return true continue the search
+     * @return false stop the search
+     */
+    bool stop_condition() const;
+
+    /**
+     * @brief Run the 4 phases of MCTS algorithm until stop condition, with the random
+     * generator of the thread
+     *
+     */
+    void run();
+
+    /**
+     * @brief Set the random generator of the thread
+     *
+     * @param generator the generator
+     */
+    void seed(const std::mt19937 &generator);
+
+    /**
+     * @brief Search the tree of another thread (tree parallelization)
+     *
+     * @param tree_owner thread whose tree is searched
+     */
+    void share_tree(const MCTSWorker &tree_owner);
+
+    /**
+     * @brief Write the state of the thread (turns, random generator, helpers and tree)
+     * for a checkpoint, the thread must not be running
+     *
+     * @param writer the checkpoint
+     * @param with_tree false if the tree is written by another thread
+     */
+    void save(BinaryWriter &writer, const bool with_tree) const;
+
+    /**
+     * @brief Read the state of the thread written by save
+     *
+     * @param reader the checkpoint
+     * @param with_tree false if the tree is read by another thread
+     */
+    void load(BinaryReader &reader, const bool with_tree);
+
+    /**
+     * @brief Start a turn from the root with the base solution
+     *
+     */
+    void start_turn();
+
+    /**
+     * @brief Selection phase of the MCTS algorithm, starts again from the root if the
+     * lazy pruning empties the selected node
+     *
+     */
+    void selection();
+
+    /**
+     * @brief Expansion phase of the MCTS algorithm, the moves leading to a partial
+     * solution dominated by an equivalent one of the tree are skipped
+     *
+     */
+    void expansion();
+
+    /**
+     * @brief Update the nodes of the path with the score of the turn, from the leaf to
+     * the root
+     *
+     * @param score score of the solution
+     */
+    void backpropagation(const int score);
+
+    /**
+     * @brief Give the result of a local search to the adaptive helper
+     *
+     * @param operator_number operator used
+     * @param score_before_ls score of the solution before the local search
+     * @param solution solution after the local search
+     */
+    void update_adaptive_helper(const int operator_number,
+                                const int score_before_ls,
+                                const Solution &solution);
+
+    /**
+     * @brief End the turn of the nodes of the path : back-propagation, update of the best
+     * solution, cleaning of the tree and eviction of subtrees if the tree exceeds its
+     * memory budget
+     *
+     * @param solution solution reached by the turn
+     */
+    void end_turn(const Solution &solution);
+
+    /**
+     * @brief End the turn of a simulation finished by the simulation pool
+     *
+     * @param simulation the simulation with the improved solution
+     */
+    void end_simulation(Simulation &&simulation);
+
+    /**
+     * @brief Return the number of turns done by the thread
+     *
+     * @return long number of turns
+     */
+    [[nodiscard]] long turn() const;
+
+    /**
+     * @brief Return the memory used by the nodes of the tree in bytes
+     *
+     * @return std::size_t memory of the tree
+     */
+    [[nodiscard]] std::size_t tree_memory() const;
+
+    /**
+     * @brief Return the highest memory used by the nodes of the tree in bytes
+     *
+     * @return std::size_t peak memory of the tree
+     */
+    [[nodiscard]] std::size_t peak_tree_memory() const;
+
+    /**
+     * @brief Return the depth of the root node
+     *
+     * @return int depth
+     */
+    [[nodiscard]] int root_depth() const;
+
+    /**
+     * @brief Convert the tree in dot format into a file
+     *
+     * @param file_name name of the file
+     */
+    void to_dot(const std::string &file_name) const;
+};
+
+/**
+ * @brief Method for Monte Carlo Tree Search
+ *
+ * With several threads (--threads), the threads share the best solution and the best
+ * score is used to prune the moves of all the trees (see MCTSWorker) :
+ * - root parallelization : each thread searches its own tree
+ * - tree parallelization : the threads search the same tree, a virtual loss on the nodes
+ * being searched makes the other threads select other nodes (see Tree)
+ *
+ * With a checkpoint file (--checkpoint), the threads stop at each period and at the end
+ * of the search (time limit, SIGTERM) to write the trees, the best solution, the helpers
+ * and the random generators. A new process continues the search with --resume
+ *
+ */
+class MCTS : public Method {
+    friend class MCTSWorker;
+
+  private:
+    /** @brief Best found solution (protected by _best_mutex)*/
+    Solution _best_solution;
+    /** @brief Score of the best found solution, read without locking*/
+    std::atomic<int> _best_score;
+    /** @brief Protect the best solution and the time to find it*/
+    mutable std::mutex _best_mutex{};
     /** @brief Time before founding best score*/
     std::chrono::high_resolution_clock::time_point _t_best{};
+    /** @brief True once a tree is fully explored (the best solution is optimal)*/
+    std::atomic<bool> _fully_explored{false};
     /** @brief Function to call for initialize the solutions*/
     init_ptr _initialization;
     /** @brief Function to call as local search*/
     std::vector<local_search_ptr> _local_search;
     /** @brief Function to call for simulation*/
     simulation_ptr _simulation;
+    /** @brief Search of each thread*/
+    std::vector<std::unique_ptr<MCTSWorker>> _workers{};
+    /** @brief The threads stop at this time to write a checkpoint*/
+    std::chrono::high_resolution_clock::time_point _period_end{};
+    /** @brief True if the search is resumed from a checkpoint*/
+    bool _resumed{false};
 
-    /** @brief Helper to choose the next pair of operator*/
-    std::unique_ptr<AdaptiveHelper> _adaptive_helper{};
-
-  public:
     /**
-     * @brief Construct a new MCTS object
+     * @brief Replace the best solution if the solution is better and print it
      *
+     * @param solution the solution found by a thread
+     * @param depth depth of the node that lead to the solution
      */
-    explicit MCTS();
-
-    ~MCTS();
+    void update_best_solution(const Solution &solution, const int depth);
 
     /**
-     * @brief Stopping condition for the MCTS search depending on turn, time limit and the
-     * tree fully explored or not
+     * @brief Stopping condition of the search depending on turns, time limit, target and
+     * a tree fully explored or not
      *
      * @return true continue the search
      * @return false stop the search
      */
-    bool stop_condition() const;
+    [[nodiscard]] bool stop_condition() const;
 
     /**
-     * @brief Run the 4 phases of MCTS algorithm until stop condition
+     * @brief Write the state of the search in the checkpoint file, the threads must not
+     * be running
      *
      */
-    void run() override;
+    void save_checkpoint() const;
 
     /**
-     * @brief Selection phase of the MCTS algorithm
+     * @brief Load a checkpoint and read its header, exit if the checkpoint can't be read
+     * or doesn't match the instance and the parameters
      *
+     * @param reader the reader of the checkpoint
+     * @param file_name the checkpoint file
      */
-    void selection();
+    static void open_checkpoint(BinaryReader &reader, const std::string &file_name);
 
     /**
-     * @brief Expansion phase of the MCTS algorithm
+     * @brief Replace the state of the search with the one of a checkpoint, exit if the
+     * checkpoint is corrupted
      *
+     * @param reader the reader of the checkpoint, after its header
+     * @param file_name the checkpoint file
      */
-    void expansion();
+    void resume(BinaryReader &reader, const std::string &file_name);
+
+    /**
+     * @brief Return string of a line of the MCTS csv format
+     *
+     * @param depth depth of the node that lead to the best solution
+     * @return std::string line for csv file
+     */
+    [[nodiscard]] const std::string line_csv(const int depth) const;
+
+  public:
+    /**
+     * @brief Construct a new MCTS object
+     *
+     */
+    explicit MCTS();
+
+    ~MCTS();
+
+    /**
+     * @brief Return the number of turns done by all the threads
+     *
+     * @return long number of turns
+     */
+    [[nodiscard]] long nb_turns() const;
+
+    /**
+     * @brief Run the threads until their stop condition
+     *
+     */
+    void run() override;
 
     /**
      * @brief Return string of the MCTS csv format
@@ -87,19 +328,13 @@ class MCTS : public Method {
      * @return std::string line for csv file
      */
     [[nodiscard]] const std::string line_csv() const override;
-
-    /**
-     * @brief Convert the tree in dot format into a file
-     *
-     * @param file_name name of the file
-     */
-    void to_dot(const std::string &file_name) const;
 };
 
 /**
  * @brief Give the next possible moves with the current placement of vertices
  *
- * @return std::vector<Action> List of next moves
+ * @return std::vector<Action> List of next moves, as a heap ordered by compare_actions
+ * (the next move to take is the first one)
  */
 std::vector<Action> next_possible_moves(const Solution &solution);
 
@@ -8,6 +8,26 @@ void SimulationHelper::accept_solution(const Solution &solution) {
     fit_condition = std::min(solution.score_wvcp(), fit_condition);
 }
 
+void SimulationHelper::save(BinaryWriter &writer) const {
+    writer.write(fit_condition);
+    const uint64_t nb_past_solutions = past_solutions.size();
+    writer.write(nb_past_solutions);
+    for (const auto &past_solution : past_solutions) {
+        writer.write_vector(past_solution);
+    }
+    writer.write_vector(past_nb_colors);
+}
+
+void SimulationHelper::load(BinaryReader &reader) {
+    fit_condition = reader.read<int>();
+    const auto nb_past_solutions = reader.read<uint64_t>();
+    past_solutions.clear();
+    for (uint64_t i = 0; i < nb_past_solutions and not reader.failed(); ++i) {
+        past_solutions.push_back(reader.read_vector<int>());
+    }
+    past_nb_colors = reader.read_vector<int>();
+}
+
 bool SimulationHelper::distant_enough(const Solution &solution) {
     bool distant_enough = true;
     const auto &colors = solution.colors();
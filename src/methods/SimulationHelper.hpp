@@ -2,6 +2,7 @@
 
 #include "../representation/Parameters.hpp"
 #include "../representation/Solution.hpp"
+#include "../utils/binary_stream.hpp"
 #include "LocalSearch.hpp"
 
 struct SimulationHelper {
@@ -18,6 +19,9 @@ struct SimulationHelper {
     bool score_low_enough(const Solution &solution);
     bool level_ok(const Solution &solution);
     bool depth_chance_ok(const Solution &solution);
+
+    void save(BinaryWriter &writer) const;
+    void load(BinaryReader &reader);
 };
 
 /** @brief Pointer to simulation function*/
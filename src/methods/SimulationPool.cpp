@@ -0,0 +1,73 @@
+#include "SimulationPool.hpp"
+
+#include <utility>
+
+#include "../utils/random_generator.hpp"
+
+SimulationPool::SimulationPool(const std::vector<local_search_ptr> &local_search,
+                               const int nb_threads)
+    : _local_search(local_search) {
+    for (int thread = 0; thread < nb_threads; ++thread) {
+        const auto seed = rd::generator();
+        _threads.emplace_back([this, seed]() { work(seed); });
+    }
+}
+
+SimulationPool::~SimulationPool() {
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _submitted.notify_all();
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+void SimulationPool::work(const std::mt19937::result_type seed) {
+    rd::generator.seed(seed);
+    while (true) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _submitted.wait(lock, [this]() { return _stop or not _waiting.empty(); });
+        if (_waiting.empty()) {
+            return;
+        }
+        Simulation simulation = std::move(_waiting.front());
+        _waiting.pop_front();
+        lock.unlock();
+
+        _local_search[simulation.operator_number](simulation.solution, false);
+
+        lock.lock();
+        _done.emplace_back(std::move(simulation));
+        lock.unlock();
+        _finished.notify_one();
+    }
+}
+
+void SimulationPool::submit(Simulation &&simulation) {
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _waiting.emplace_back(std::move(simulation));
+        ++_nb_pending;
+    }
+    _submitted.notify_one();
+}
+
+[[nodiscard]] Simulation SimulationPool::wait_result() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [this]() { return not _done.empty(); });
+    Simulation simulation = std::move(_done.front());
+    _done.pop_front();
+    --_nb_pending;
+    return simulation;
+}
+
+[[nodiscard]] int SimulationPool::nb_pending() {
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _nb_pending;
+}
+
+[[nodiscard]] int SimulationPool::nb_threads() const {
+    return static_cast<int>(_threads.size());
+}
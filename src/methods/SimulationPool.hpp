@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../representation/Tree.hpp"
+#include "../representation/Solution.hpp"
+#include "LocalSearch.hpp"
+
+/**
+ * @brief Local search of a leaf of the tree run by the simulation pool
+ *
+ */
+struct Simulation {
+    /** @brief Solution of the leaf, improved by the local search*/
+    Solution solution;
+    /** @brief Nodes from the root to the leaf, they keep their virtual loss until the
+     * result is back-propagated*/
+    std::vector<NodeId> path;
+    /** @brief Operator chosen by the adaptive helper*/
+    int operator_number;
+    /** @brief Score of the solution before the local search*/
+    int score_before_ls;
+};
+
+/**
+ * @brief Threads running the local searches of several leaves at the same time
+ *
+ * The MCTS thread submits the leaves and keeps on selecting new leaves (the virtual loss
+ * of the pending leaves makes it select other nodes) until all the threads of the pool
+ * are busy, then it waits for the first finished local search
+ *
+ */
+class SimulationPool {
+  private:
+    /** @brief Local search operators*/
+    const std::vector<local_search_ptr> &_local_search;
+    /** @brief Threads of the pool*/
+    std::vector<std::thread> _threads{};
+    /** @brief Protect the queues and the counters*/
+    std::mutex _mutex{};
+    /** @brief Signaled when a simulation is submitted or when the pool stops*/
+    std::condition_variable _submitted{};
+    /** @brief Signaled when a simulation is finished*/
+    std::condition_variable _finished{};
+    /** @brief Simulations waiting for a thread*/
+    std::deque<Simulation> _waiting{};
+    /** @brief Simulations finished and not yet collected*/
+    std::deque<Simulation> _done{};
+    /** @brief Number of simulations submitted and not yet collected*/
+    int _nb_pending{0};
+    /** @brief True when the threads must stop*/
+    bool _stop{false};
+
+    /**
+     * @brief Run the simulations until the pool stops
+     *
+     * @param seed seed of the random generator of the thread
+     */
+    void work(const std::mt19937::result_type seed);
+
+  public:
+    /**
+     * @brief Start the threads, their random generators are seeded from the random
+     * generator of the calling thread
+     *
+     * @param local_search local search operators
+     * @param nb_threads number of threads
+     */
+    SimulationPool(const std::vector<local_search_ptr> &local_search, const int nb_threads);
+
+    SimulationPool(const SimulationPool &) = delete;
+    SimulationPool &operator=(const SimulationPool &) = delete;
+
+    /**
+     * @brief Stop the threads once the submitted simulations are done
+     *
+     */
+    ~SimulationPool();
+
+    /**
+     * @brief Add a leaf to the simulations to run
+     *
+     * @param simulation the leaf and the operator to apply
+     */
+    void submit(Simulation &&simulation);
+
+    /**
+     * @brief Wait for a simulation to finish, the simulations are given in the order they
+     * finish
+     *
+     * @return Simulation the simulation with the improved solution
+     */
+    [[nodiscard]] Simulation wait_result();
+
+    /**
+     * @brief Return the number of simulations submitted and not yet collected
+     *
+     * @return int number of simulations
+     */
+    [[nodiscard]] int nb_pending();
+
+    /**
+     * @brief Return the number of threads of the pool
+     *
+     * @return int number of threads
+     */
+    [[nodiscard]] int nb_threads() const;
+};
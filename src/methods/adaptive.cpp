@@ -100,6 +100,42 @@ std::string AdaptiveHelper::get_selected_str() const {
     return std::to_string(past_operators[index]);
 }
 
+void AdaptiveHelper::save(BinaryWriter &writer) const {
+    writer.write(nb_operators);
+    writer.write(memory_size);
+    writer.write(turn);
+    writer.write_vector(proba_operator);
+    writer.write_vector(utility);
+    writer.write_vector(past_operators);
+    writer.write_vector(normalized_utilities);
+    writer.write_vector(nb_times_selected);
+    writer.write_vector(nb_times_used_total);
+    writer.write_vector(mean_score);
+    writer.write_vector(
+        std::vector<int>(possible_operators.begin(), possible_operators.end()));
+    writer.write_vector(
+        std::vector<int>(removed_operators.begin(), removed_operators.end()));
+}
+
+void AdaptiveHelper::load(BinaryReader &reader) {
+    if (reader.read<int>() != nb_operators or reader.read<int>() != memory_size) {
+        reader.fail();
+        return;
+    }
+    turn = reader.read<int>();
+    proba_operator = reader.read_vector<double>();
+    utility = reader.read_vector<double>();
+    past_operators = reader.read_vector<int>();
+    normalized_utilities = reader.read_vector<double>();
+    nb_times_selected = reader.read_vector<int>();
+    nb_times_used_total = reader.read_vector<int>();
+    mean_score = reader.read_vector<double>();
+    const auto possible = reader.read_vector<int>();
+    possible_operators = std::set<int>(possible.begin(), possible.end());
+    const auto removed = reader.read_vector<int>();
+    removed_operators = std::set<int>(removed.begin(), removed.end());
+}
+
 /************************************************************************
  *
  *                         AdaptiveHelper_none
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <set>
 #include <vector>
 
 #include "../representation/Solution.hpp"
 #include "../representation/enum_types.hpp"
+#include "../utils/binary_stream.hpp"
 #include "neural_network.hpp"
 
 /**
@@ -82,6 +84,22 @@ class AdaptiveHelper {
 
     std::string to_str_proba() const;
     std::string get_selected_str() const;
+
+    /**
+     * @brief Write the state of the helper (probabilities, window of the past operators
+     * and their utilities, statistics) for a checkpoint
+     *
+     * @param writer the checkpoint
+     */
+    virtual void save(BinaryWriter &writer) const;
+
+    /**
+     * @brief Read the state of the helper written by save, the helper must have the same
+     * number of operators and window size
+     *
+     * @param reader the checkpoint
+     */
+    virtual void load(BinaryReader &reader);
 };
 
 /**
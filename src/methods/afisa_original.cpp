@@ -1,8 +1,31 @@
 #include "afisa_original.hpp"
 
+#include "../representation/MoveCache.hpp"
 #include "../utils/random_generator.hpp"
 #include "../utils/utils.hpp"
+#include "LocalSearchEngine.hpp"
 
+/**
+ * @brief The move back is tabu for a random number of turns in [0, 10] plus the score
+ * and 0.6 times the penalty coefficient times the penalty
+ */
+struct TabuPenalizedScore {
+    static constexpr bool enabled = true;
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief Coefficient of the penalty*/
+    const int penalty_coeff;
+    /** @brief Random part of the tenure*/
+    std::uniform_int_distribution<int> distribution{0, 10};
+
+    [[nodiscard]] long tenure(const long) {
+        return distribution(rd::generator) +
+               static_cast<int>(solution.score_wvcp() +
+                                penalty_coeff * solution.penalty() * 0.6);
+    }
+};
+
+template <typename Problem>
 void afisa_original(Solution &best_solution, const bool verbose) {
     // best_solution stay legal during the search, its updated when a
     // new best score with no penalty is found
@@ -13,7 +36,9 @@ void afisa_original(Solution &best_solution, const bool verbose) {
     int64_t best_time = 0;
     std::uniform_int_distribution<int> distribution(0, 100);
     // best_afisa_sol can have conflict between vertices
-    Solution best_afisa_sol = best_solution;
+    SolutionSnapshot best_afisa_sol(best_solution);
+    // each turn starts back from best_afisa_sol, only the moved vertices are restored
+    Solution solution = best_solution;
     int penalty_coeff = 1;
     int no_improvement = 0;
     long turn_afisa = 0;
@@ -27,20 +52,20 @@ void afisa_original(Solution &best_solution, const bool verbose) {
            best_solution.score_wvcp() != Parameters::p->target) {
         ++turn_afisa;
 
-        Solution solution = best_afisa_sol;
+        best_afisa_sol.restore(solution);
         // tabu phase
-        afisa_original_tabu(solution,
-                            best_solution,
-                            best_afisa_sol,
-                            penalty_coeff,
-                            nb_turn_tabu,
-                            Perturbation::no_perturbation,
-                            max_time);
+        afisa_original_tabu<Problem>(solution,
+                                     best_solution,
+                                     best_afisa_sol,
+                                     penalty_coeff,
+                                     nb_turn_tabu,
+                                     Perturbation::no_perturbation,
+                                     max_time);
 
         // if new best score found
         if (best_afisa_sol.score_wvcp() < best_solution.score_wvcp() and
             best_afisa_sol.penalty() == 0) {
-            best_solution = best_afisa_sol;
+            best_afisa_sol.restore(best_solution);
             no_improvement = 0;
             perturbation = small_perturbation;
             if (verbose) {
@@ -52,7 +77,7 @@ void afisa_original(Solution &best_solution, const bool verbose) {
             // if this is a new best solution with the same score
             if (best_afisa_sol.score_wvcp() == best_solution.score_wvcp() and
                 best_afisa_sol.penalty() == 0) {
-                best_solution = best_afisa_sol;
+                best_afisa_sol.restore(best_solution);
             }
             no_improvement++;
             if (no_improvement == 50) {
@@ -71,103 +96,40 @@ void afisa_original(Solution &best_solution, const bool verbose) {
         }
 
         // perturbation phase
-        afisa_original_tabu(solution,
-                            best_solution,
-                            best_afisa_sol,
-                            penalty_coeff,
-                            perturbation,
-                            (distribution(rd::generator) < 50 ? Perturbation::no_tabu
-                                                              : Perturbation::unlimited),
-                            max_time);
+        afisa_original_tabu<Problem>(
+            solution,
+            best_solution,
+            best_afisa_sol,
+            penalty_coeff,
+            perturbation,
+            (distribution(rd::generator) < 50 ? Perturbation::no_tabu
+                                              : Perturbation::unlimited),
+            max_time);
     }
     if (verbose) {
         print_result_ls(best_time, best_solution, turn_afisa);
     }
 }
 
+template <typename Problem>
 void afisa_original_tabu(Solution &solution,
                          const Solution &best_solution,
-                         Solution &best_afisa_sol,
+                         SolutionSnapshot &best_afisa_sol,
                          const int &penalty_coeff,
                          const long &turns,
                          const Perturbation &perturbation,
                          const std::chrono::high_resolution_clock::time_point &max_time) {
     const int nb_max_colors = static_cast<int>(std::max(solution.nb_colors(), 15) * 1.15);
-    std::vector<std::vector<long>> tabu_matrix(Graph::g->nb_vertices,
-                                               std::vector<long>(nb_max_colors, 0));
-    std::uniform_int_distribution<int> distribution(0, 10);
-    // tabu search loop
-    long turn_tabu{0};
-    while (not Parameters::p->time_limit_reached_sub_method(max_time) and
-           turn_tabu < turns) {
-        turn_tabu++;
-        std::vector<Coloration> best_coloration;
-        int best_evaluation = std::numeric_limits<int>::max();
-
-        auto possible_colors = solution.non_empty_colors();
-        if (static_cast<int>(possible_colors.size()) < nb_max_colors) {
-            possible_colors.push_back(-1);
-        }
-
-        for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-            for (const int &color : possible_colors) {
-                if (color == solution.color(vertex)) {
-                    continue;
-                }
-                // penalty is
-                // - penalty from current position if the vertex move to a new color
-                // new penalty - penalty from current position otherwise
-                const int delta_penalty = solution.delta_conflicts(vertex, color);
-                const int test_score =
-                    solution.score_wvcp() + solution.delta_wvcp_score(vertex, color) +
-                    penalty_coeff * (delta_penalty + solution.penalty());
-                // save best moves
-                if ((test_score < best_evaluation and
-                     tabu_matrix[vertex][color] <= turn_tabu) or
-                    (test_score < best_solution.score_wvcp() and
-                     (solution.penalty() + delta_penalty == 0))) {
-                    best_coloration.clear();
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                    best_evaluation = test_score;
-                } else if (test_score == best_evaluation and
-                           (tabu_matrix[vertex][color] <= turn_tabu or
-                            (test_score < best_solution.score_wvcp() and
-                             (solution.penalty() + delta_penalty == 0)))) {
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                }
-            }
-        }
-        // check if a best move if found (may be empty depending on the size of the tabu
-        // list)
-        if (not best_coloration.empty()) {
-            const Coloration chosen_one{rd::choice(best_coloration)};
-            const int old_color = solution.delete_from_color(chosen_one.vertex);
-            solution.add_to_color(chosen_one.vertex, chosen_one.color);
-
-            // set tabu
-            switch (perturbation) {
-            case Perturbation::no_perturbation:
-                tabu_matrix[chosen_one.vertex][old_color] =
-                    static_cast<int>(turn_tabu) + distribution(rd::generator) +
-                    static_cast<int>(solution.score_wvcp() +
-                                     penalty_coeff * solution.penalty() * 0.6);
-                break;
-            case Perturbation::unlimited:
-                tabu_matrix[chosen_one.vertex][old_color] = turns + 1;
-                break;
-            case Perturbation::no_tabu:
-                break;
-            }
-
-            if ((solution.score_wvcp() + penalty_coeff * solution.penalty()) <
-                (best_afisa_sol.score_wvcp() +
-                 penalty_coeff * best_afisa_sol.penalty())) {
-                best_afisa_sol = solution;
-            }
-
-            if (solution.score_wvcp() == Parameters::p->target) {
-                return;
-            }
-        }
-    }
+    // a vertex is tabu for its old color, a new color is never tabu
+    MoveCache moves(solution, penalty_coeff, true, nb_max_colors);
+    run_perturbation(
+        perturbation,
+        CachedNeighborhood<Problem, false>(moves),
+        TabuPenalizedScore{solution, penalty_coeff},
+        PenalizedScoreAcceptance{solution, best_solution, best_afisa_sol, penalty_coeff},
+        turns,
+        max_time);
 }
+
+template void afisa_original<ProblemWVCP>(Solution &solution, const bool verbose);
+template void afisa_original<ProblemGCP>(Solution &solution, const bool verbose);
@@ -10,14 +10,17 @@
  * Adaptive feasible and infeasible tabu search for weighted vertex coloring.
  * Information Sciences 466, 203–219. https://doi.org/10.1016/j.ins.2018.07.037
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution solution to use, the solution will be modified but stay legal
  * @param verbose True if print csv line each time new best scores is found
  */
+template <typename Problem>
 void afisa_original(Solution &solution, const bool verbose = false);
 
 /**
  * @brief Tabu search for afisa
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution current solution (may not be legal)
  * @param best_solution ref solution for aspiration criteria (legal)
  * @param best_afisa_sol best afisa solution (may not be legal)
@@ -26,9 +29,10 @@ void afisa_original(Solution &solution, const bool verbose = false);
  * @param perturbation type of perturbation
  * @param max_time time limit for the local search
  */
+template <typename Problem>
 void afisa_original_tabu(Solution &solution,
                          const Solution &best_solution,
-                         Solution &best_afisa_sol,
+                         SolutionSnapshot &best_afisa_sol,
                          const int &penalty_coeff,
                          const long &turns,
                          const Perturbation &perturbation,
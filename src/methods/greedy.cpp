@@ -1,14 +1,15 @@
 #include "greedy.hpp"
 
 #include <cassert>
+#include <set>
 
 #include "../utils/random_generator.hpp"
 #include "../utils/utils.hpp"
 
 void total_random(Solution &solution) {
-    // shuffle the vertices
-    std::vector<int> vertices(Graph::g->nb_vertices);
-    std::iota(vertices.begin(), vertices.end(), 0);
+    // shuffle the vertices not colored yet
+    std::vector<int> vertices(Graph::g->nb_vertices - solution.first_free_vertex());
+    std::iota(vertices.begin(), vertices.end(), solution.first_free_vertex());
     std::shuffle(vertices.begin(), vertices.end(), rd::generator);
     for (const auto vertex : vertices) {
         auto possible_colors = solution.available_colors(vertex);
@@ -83,7 +84,10 @@ struct maxSat {
 };
 
 void greedy_DSatur(Solution &solution) {
-    std::vector<int> degrees(Graph::g->degrees);
+    std::vector<int> degrees(Graph::g->nb_vertices);
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        degrees[vertex] = Graph::g->degree(vertex);
+    }
     std::vector<std::set<int>> adjacent_colors(Graph::g->nb_vertices, std::set<int>());
     std::set<satItem, maxSat> Q;
 
@@ -92,7 +96,7 @@ void greedy_DSatur(Solution &solution) {
         for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
             const auto color = solution.color(vertex);
             if (color != -1) {
-                for (const int neighbor : Graph::g->neighborhood[vertex]) {
+                for (const int neighbor : Graph::g->neighbors(vertex)) {
                     if (solution.color(neighbor) == -1) {
                         adjacent_colors[neighbor].insert(color);
                         --degrees[neighbor];
@@ -139,7 +143,7 @@ void greedy_DSatur(Solution &solution) {
 
         // Update the saturation degrees and d-value of all uncolored neighbors; hence
         // modify their corresponding elements in the priority queue
-        for (const int neighbor : Graph::g->neighborhood[vertex]) {
+        for (const int neighbor : Graph::g->neighbors(vertex)) {
             if (solution.color(neighbor) == -1) {
                 Q.erase({static_cast<int>(adjacent_colors[neighbor].size()),
                          Graph::g->weights[neighbor],
@@ -169,7 +173,7 @@ void update_neighborhood(const Solution &solution,
     // each uncolored neighbor of the current vertex goes in the illegal set
     // the neighbor and its neighbors are impacted by the move
     std::vector<int> impacted_vertices;
-    for (const int neighbor : Graph::g->neighborhood[current_vertex]) {
+    for (const int neighbor : Graph::g->neighbors(current_vertex)) {
         if (solution.color(neighbor) == -1) {
             erase_sorted(legal_uncolored, neighbor);
             // legal_uncolored.erase(neighbor);
@@ -179,7 +183,7 @@ void update_neighborhood(const Solution &solution,
             // impacted_vertices.insert(neighbor);
             if (not contains(impacted_vertices, neighbor))
                 insert_sorted(impacted_vertices, neighbor);
-            for (int w : Graph::g->neighborhood[neighbor]) {
+            for (int w : Graph::g->neighbors(neighbor)) {
                 if (solution.color(w) == -1) {
                     if (not contains(impacted_vertices, w))
                         insert_sorted(impacted_vertices, w);
@@ -194,7 +198,7 @@ void update_neighborhood(const Solution &solution,
     for (const int vertex : impacted_vertices) {
         nb_uncolored_neighbors[vertex] = 0;
         nb_illegal_neighbors[vertex] = 0;
-        for (int neighbor : Graph::g->neighborhood[vertex]) {
+        for (int neighbor : Graph::g->neighbors(vertex)) {
             if (solution.color(neighbor) == -1) {
                 // if (legal_uncolored.count(neighbor) == 1)
                 if (contains(legal_uncolored, neighbor))
@@ -231,7 +235,7 @@ void greedy_RLF(Solution &solution) {
 
         for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
             if (solution.color(vertex) == color) {
-                for (const auto neighbor : Graph::g->neighborhood[vertex]) {
+                for (const auto neighbor : Graph::g->neighbors(vertex)) {
                     if (solution.color(neighbor) == -1) {
                         if (contains(legal_uncolored, neighbor)) {
                             erase_sorted(legal_uncolored, neighbor);
@@ -239,14 +243,14 @@ void greedy_RLF(Solution &solution) {
                         if (not contains(illegal_uncolored, neighbor)) {
                             insert_sorted(illegal_uncolored, neighbor);
                             for (const auto neighbor2 :
-                                 Graph::g->neighborhood[neighbor]) {
+                                 Graph::g->neighbors(neighbor)) {
                                 ++nb_illegal_neighbors[neighbor2];
                             }
                         }
                     }
                 }
             } else if (solution.color(vertex) == -1) {
-                for (int neighbor : Graph::g->neighborhood[vertex]) {
+                for (int neighbor : Graph::g->neighbors(vertex)) {
                     if (contains(legal_uncolored, neighbor)) {
                         nb_uncolored_neighbors[vertex]++;
                     }
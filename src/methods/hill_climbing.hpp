@@ -5,7 +5,9 @@
 /**
  * @brief Hill climbing with a one move operator, will stop when reach a best local score
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution solution to use, the solution will be modified
  * @param verbose True if print csv line each time new best scores is found
  */
+template <typename Problem>
 void hill_climbing_one_move(Solution &solution, const bool verbose = false);
@@ -14,6 +14,7 @@ void ilsts(Solution &best_solution, const bool verbose) {
     int64_t best_time = 0;
 
     ProxiSolutionILSTS working_solution(best_solution);
+    SolutionSnapshot best_snapshot(best_solution);
     std::vector<long> tabu(Graph::g->nb_vertices, 0);
 
     long no_improve = 0; // number of iterations without improvement
@@ -26,7 +27,7 @@ void ilsts(Solution &best_solution, const bool verbose) {
 
     while (turn < Parameters::p->nb_iter_local_search and
            not Parameters::p->time_limit_reached_sub_method(max_time) and
-           best_solution.score_wvcp() != Parameters::p->target) {
+           best_snapshot.score_wvcp() != Parameters::p->target) {
         ++turn;
         ProxiSolutionILSTS next_s(working_solution);
 
@@ -76,18 +77,19 @@ void ilsts(Solution &best_solution, const bool verbose) {
         }
 
         if ((not working_solution.has_unassigned_vertices()) and
-            (best_solution.score_wvcp() > working_solution.score_wvcp())) {
-            best_solution = working_solution.solution();
+            (best_snapshot.score_wvcp() > working_solution.score_wvcp())) {
+            best_snapshot.save(working_solution.solution());
             if (verbose) {
                 best_time = Parameters::p->elapsed_time(
                     std::chrono::high_resolution_clock::now());
-                print_result_ls(best_time, best_solution, turn);
+                print_result_ls(best_time, working_solution.solution(), turn);
             }
         } else if ((not working_solution.has_unassigned_vertices()) and
-                   (best_solution.score_wvcp() == working_solution.score_wvcp())) {
-            best_solution = working_solution.solution();
+                   (best_snapshot.score_wvcp() == working_solution.score_wvcp())) {
+            best_snapshot.save(working_solution.solution());
         }
     }
+    best_snapshot.restore(best_solution);
     if (verbose) {
         print_result_ls(best_time, best_solution, turn);
     }
@@ -126,7 +128,7 @@ bool M_1_2_3(ProxiSolutionILSTS &solution, const long iter, std::vector<long> &t
         std::vector<int> costs(solution.nb_colors(), 0);
         // relocated counts the number of neighbors that must be relocated for each color
         std::vector<int> relocated(solution.nb_colors(), 0);
-        for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
+        for (const auto &neighbor : Graph::g->neighbors(vertex)) {
             // if neighbor is unassigned, we don't care
             int neighbor_color = solution.color(neighbor);
             if (neighbor_color == -1) {
@@ -158,7 +160,7 @@ bool M_1_2_3(ProxiSolutionILSTS &solution, const long iter, std::vector<long> &t
             if (costs[neighbor_color] == 0) {
                 // we apply the grenade move on the vertex and neighbors
                 std::vector<int> unassigned;
-                for (int y : Graph::g->neighborhood[vertex]) {
+                for (int y : Graph::g->neighbors(vertex)) {
                     if (solution.color(y) == neighbor_color) {
                         assert(solution.nb_free_colors(y) > 0);
                         solution.delete_from_color(y);
@@ -197,7 +199,7 @@ bool M_3(ProxiSolutionILSTS &solution,
     }
     const auto [vertex, min_color] = rd::choice(grenade_one_lost);
     std::vector<int> unassigned;
-    for (const auto &y : Graph::g->neighborhood[vertex]) {
+    for (const auto &y : Graph::g->neighbors(vertex)) {
         if (solution.color(y) == min_color) {
             if (solution.nb_free_colors(y) > 0) {
                 unassigned.push_back(y);
@@ -255,7 +257,7 @@ bool M_5(ProxiSolutionILSTS &solution,
             continue;
         }
         std::vector<int> relocated(solution.nb_colors(), 0);
-        for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
+        for (const auto &neighbor : Graph::g->neighbors(vertex)) {
             int c_neighbor = solution.color(neighbor);
             if (c_neighbor == -1)
                 continue;
@@ -268,7 +270,7 @@ bool M_5(ProxiSolutionILSTS &solution,
             }
             if (relocated[c_neighbor] == solution.conflicts_colors(c_neighbor, vertex)) {
                 std::vector<int> unassigned;
-                for (const auto &y : Graph::g->neighborhood[vertex]) {
+                for (const auto &y : Graph::g->neighbors(vertex)) {
                     if (solution.color(y) == c_neighbor and
                         solution.nb_free_colors(y) > 0) {
                         solution.delete_from_color(y);
@@ -299,7 +301,7 @@ bool M_6(ProxiSolutionILSTS &solution, const long iter, std::vector<long> &tabu)
     std::vector<int> relocated(solution.nb_colors(), 0);
     std::vector<int> costs(solution.nb_colors(), 0);
 
-    for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
+    for (const auto &neighbor : Graph::g->neighbors(vertex)) {
         const int c_neighbor = solution.color(neighbor);
         if (c_neighbor == -1)
             continue;
@@ -325,7 +327,7 @@ bool M_6(ProxiSolutionILSTS &solution, const long iter, std::vector<long> &tabu)
     }
     std::vector<int> unassigned;
     std::fill(tabu.begin(), tabu.end(), 0);
-    for (const auto &y : Graph::g->neighborhood[vertex]) {
+    for (const auto &y : Graph::g->neighbors(vertex)) {
         if (solution.color(y) == min_cost_c) {
             if (solution.nb_free_colors(y) > 0) {
                 unassigned.push_back(y);
@@ -4,15 +4,16 @@
 #include <assert.h>
 #include <numeric>
 #include <random>
-#include <set>
 #include <vector>
 
 #include "../utils/random_generator.hpp"
+#include "../utils/sparse_set.hpp"
 #include "../utils/utils.hpp"
 
-std::set<int> remove_color_unassigned(Solution &solution) {
+template <typename Problem> SparseSet remove_color_unassigned(Solution &solution) {
     // look for the best color group to relocate them in an
     // other color without having too much unassigned vertices
+    const std::size_t nb_words = bitset_nb_words(Graph::g->nb_vertices);
     int best_sum_conflicts = Graph::g->nb_vertices;
     int best_color1 = -1;
     int best_color2 = -1;
@@ -22,9 +23,9 @@ std::set<int> remove_color_unassigned(Solution &solution) {
                 continue;
             }
             int sum_conflicts{0};
-            for (const int vertex : solution.colors_vertices(color1)) {
+            bitset_for_each(solution.colors_bits(color1), nb_words, [&](const int vertex) {
                 sum_conflicts += solution.conflicts_colors(color2, vertex);
-            }
+            });
             if (sum_conflicts < best_sum_conflicts) {
                 best_color1 = color1;
                 best_color2 = color2;
@@ -34,19 +35,21 @@ std::set<int> remove_color_unassigned(Solution &solution) {
     }
     // delete the vertices in the color and try to relocate them in the second color
     // if not possible add them to a unassigned set
-    std::set<int> unassigned;
-    const auto to_delete = solution.colors_vertices(best_color1);
-    for (const auto vertex : to_delete) {
-        solution.delete_from_color(vertex);
+    SparseSet unassigned(Graph::g->nb_vertices);
+    const BitsetWords to_delete(solution.colors_bits(best_color1),
+                                solution.colors_bits(best_color1) + nb_words);
+    bitset_for_each(to_delete.data(), nb_words, [&](const int vertex) {
+        solution.delete_from_color<Problem>(vertex);
         if (solution.conflicts_colors(best_color2, vertex) == 0) {
-            solution.add_to_color(vertex, best_color2);
+            solution.add_to_color<Problem>(vertex, best_color2);
         } else {
             unassigned.insert(vertex);
         }
-    }
+    });
     return unassigned;
 }
 
+template <typename Problem>
 void partial_col(Solution &best_solution, const bool verbose) {
     const auto max_time = std::chrono::high_resolution_clock::now() +
                           std::chrono::seconds(Parameters::p->max_time_local_search);
@@ -58,13 +61,14 @@ void partial_col(Solution &best_solution, const bool verbose) {
     }
     std::uniform_int_distribution<int> distribution(0, 10);
     Solution solution(best_solution);
+    SolutionSnapshot best_snapshot(solution);
     int turn_main = 0;
     while (not Parameters::p->time_limit_reached_sub_method(max_time) and
            turn_main < Parameters::p->nb_iter_local_search) {
 
         ++turn_main;
 
-        std::set<int> unassigned = remove_color_unassigned(solution);
+        SparseSet unassigned = remove_color_unassigned<Problem>(solution);
         int best_found = static_cast<int>(unassigned.size());
 
         std::vector<std::vector<long>> tabu_matrix(
@@ -102,17 +106,17 @@ void partial_col(Solution &best_solution, const bool verbose) {
 
             // If no move, pick a random one
             if (best_colorations.empty()) {
-                const int vertex = rd::choice(unassigned);
+                const int vertex = rd::choice(unassigned.values());
                 const int color = rd::choice(solution.non_empty_colors());
                 best_colorations.emplace_back(Coloration{vertex, color});
             }
 
             Coloration chosen_one = rd::choice(best_colorations);
-            solution.add_to_color(chosen_one.vertex, chosen_one.color);
+            solution.add_to_color<Problem>(chosen_one.vertex, chosen_one.color);
             unassigned.erase(chosen_one.vertex);
 
             // Remove conflicting nodes
-            for (const int neighbor : Graph::g->neighborhood[chosen_one.vertex]) {
+            for (const int neighbor : Graph::g->neighbors(chosen_one.vertex)) {
                 // Do not move neighbors to best_color for a couple of iterations in order
                 // to avoid best_vertex from dropping back out too soon
                 long t_tenure =
@@ -122,7 +126,7 @@ void partial_col(Solution &best_solution, const bool verbose) {
 
                 // Check for conflict created by moving best_vertex to best_color
                 if (solution.color(neighbor) == chosen_one.color) {
-                    solution.delete_from_color(neighbor);
+                    solution.delete_from_color<Problem>(neighbor);
                     unassigned.insert(neighbor);
                 }
             }
@@ -139,7 +143,7 @@ void partial_col(Solution &best_solution, const bool verbose) {
         }
 
         if (unassigned.empty()) {
-            best_solution = solution;
+            best_snapshot.save(solution);
             if (solution.nb_non_empty_colors() < Solution::best_nb_colors) {
                 Solution::best_nb_colors =
                     static_cast<int>(solution.nb_non_empty_colors());
@@ -151,7 +155,11 @@ void partial_col(Solution &best_solution, const bool verbose) {
             }
         }
     }
+    best_snapshot.restore(best_solution);
     if (verbose) {
         print_result_ls(best_time, best_solution, turn_main);
     }
 }
+
+template void partial_col<ProblemWVCP>(Solution &solution, const bool verbose);
+template void partial_col<ProblemGCP>(Solution &solution, const bool verbose);
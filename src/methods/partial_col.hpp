@@ -5,7 +5,9 @@
 /**
  * @brief partial_col
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution solution to use, the solution will be modified
  * @param verbose True if print csv line each time new best scores is found
  */
+template <typename Problem>
 void partial_col(Solution &solution, const bool verbose = false);
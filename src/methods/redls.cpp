@@ -1,6 +1,7 @@
 #include "redls.hpp"
 
 #include <cassert>
+#include <set>
 
 #include "../utils/random_generator.hpp"
 #include "../utils/utils.hpp"
@@ -12,11 +13,12 @@ void redls(Solution &best_solution, const bool verbose) {
     int64_t best_time = 0;
 
     ProxiSolutionRedLS solution(best_solution);
+    SolutionSnapshot best_snapshot(best_solution);
     std::vector<bool> tabu_list(Graph::g->nb_vertices, false);
     long turn = 0;
     while (not Parameters::p->time_limit_reached_sub_method(max_time) and
            turn < Parameters::p->nb_iter_local_search and
-           best_solution.score_wvcp() != Parameters::p->target) {
+           best_snapshot.score_wvcp() != Parameters::p->target) {
         ++turn;
         if (solution.penalty() == 0) {
             while (improve_conflicts(solution, false, tabu_list)) {
@@ -24,21 +26,22 @@ void redls(Solution &best_solution, const bool verbose) {
             }
 
             assert(solution.penalty() == 0);
-            if (solution.score_wvcp() < best_solution.score_wvcp()) {
-                best_solution = solution.solution();
+            if (solution.score_wvcp() < best_snapshot.score_wvcp()) {
+                best_snapshot.save(solution.solution());
                 if (verbose) {
                     best_time = Parameters::p->elapsed_time(
                         std::chrono::high_resolution_clock::now());
-                    print_result_ls(best_time, best_solution, turn);
+                    print_result_ls(best_time, solution.solution(), turn);
                 }
                 if (solution.score_wvcp() == Parameters::p->target) {
                     if (verbose) {
-                        print_result_ls(best_time, best_solution, turn);
+                        print_result_ls(best_time, solution.solution(), turn);
                     }
+                    best_snapshot.restore(best_solution);
                     return;
                 }
-            } else if (solution.score_wvcp() == best_solution.score_wvcp()) {
-                best_solution = solution.solution();
+            } else if (solution.score_wvcp() == best_snapshot.score_wvcp()) {
+                best_snapshot.save(solution.solution());
             }
             std::fill(tabu_list.begin(), tabu_list.end(), false);
             move_heaviest_vertices(solution);
@@ -51,23 +54,24 @@ void redls(Solution &best_solution, const bool verbose) {
         }
 
         if (not improve_conflicts_and_score(
-                solution, best_solution.score_wvcp(), tabu_list)) {
+                solution, best_snapshot.score_wvcp(), tabu_list)) {
 
             while (improve_conflicts(solution, true, tabu_list)) {
                 assert(solution.check_solution());
             }
 
             if (not solve_one_conflict_preserve_score(
-                    solution, best_solution.score_wvcp(), tabu_list)) {
+                    solution, best_snapshot.score_wvcp(), tabu_list)) {
                 // Increments edge weight
                 solution.increment_edge_weights();
-                if (not solution.conflict_edges().empty()) {
-                    solve_one_conflict(solution, best_solution.score_wvcp(), tabu_list);
+                if (solution.has_conflict_edges()) {
+                    solve_one_conflict(solution, best_snapshot.score_wvcp(), tabu_list);
                 }
             }
             assert(solution.check_solution());
         }
     }
+    best_snapshot.restore(best_solution);
     if (verbose) {
         print_result_ls(best_time, best_solution, turn);
     }
@@ -113,7 +117,7 @@ bool improve_conflicts_and_score(ProxiSolutionRedLS &solution,
     solution.add_to_color(best_move.vertex, best_move.color);
     // the vertex become tabu while its neighbors get out of the tabu list
     tabu_list[best_move.vertex] = true;
-    for (const auto &neighbor : Graph::g->neighborhood[best_move.vertex]) {
+    for (const auto &neighbor : Graph::g->neighbors(best_move.vertex)) {
         tabu_list[neighbor] = false;
     }
 
@@ -187,6 +191,7 @@ void move_heaviest_vertices(ProxiSolutionRedLS &solution) {
     // look for the best set of heaviest vertices in each colors
     // to relocate them in an other color without increasing too
     // much the number of conflicts
+    const std::size_t nb_words = bitset_nb_words(Graph::g->nb_vertices);
     float best_ratio = 0;
     int best_color = -1;
     std::set<int> best_heaviest_vertices;
@@ -194,14 +199,14 @@ void move_heaviest_vertices(ProxiSolutionRedLS &solution) {
         const int max_weight1 = solution.max_weight(color1);
         int second_max = 0;
         std::set<int> heaviest_vertices;
-        for (const auto &vertex : solution.colors_vertices(color1)) {
+        bitset_for_each(solution.colors_bits(color1), nb_words, [&](const int vertex) {
             const int vertex_weight = Graph::g->weights[vertex];
             if (vertex_weight == max_weight1) {
                 heaviest_vertices.insert(vertex);
             } else if (vertex_weight > second_max) {
                 second_max = vertex_weight;
             }
-        }
+        });
         const int delta_move = max_weight1 - second_max;
         for (const auto &color2 : solution.non_empty_colors()) {
             if (color1 == color2) {
@@ -243,7 +248,7 @@ void solve_one_conflict(ProxiSolutionRedLS &solution,
     // otherwise a random move in a random color
     const int delta_wvcp = best_local_score - solution.score_wvcp();
     Coloration best_coloration{-1, -1};
-    const auto &[v1, v2] = rd::choice(solution.conflict_edges());
+    const auto &[v1, v2] = solution.random_conflict_edge();
     int best_score_conflicts = 0;
     for (const int &vertex : {v1, v2}) {
         for (const auto &color : solution.non_empty_colors()) {
@@ -3,10 +3,106 @@
 #include <algorithm>
 #include <cassert>
 
+#include "../representation/TabuColEngine.hpp"
 #include "../utils/random_generator.hpp"
 #include "../utils/utils.hpp"
+#include "LocalSearchEngine.hpp"
+
+/**
+ * @brief Neighborhood of the moves of a TabuColEngine, a random move is drawn if all
+ * the moves are tabu
+ *
+ * @tparam Problem ProblemWVCP or ProblemGCP
+ */
+template <typename Problem> class TabuColNeighborhood {
+  private:
+    /** @brief Moves of the solution*/
+    TabuColEngine &_engine;
+    /** @brief The solution searched*/
+    const Solution &_solution;
+    /** @brief Vertex of the random move*/
+    std::uniform_int_distribution<int> _distribution_vertices;
+
+  public:
+    TabuColNeighborhood(TabuColEngine &engine, const Solution &solution)
+        : _engine(engine),
+          _solution(solution),
+          _distribution_vertices(0, Graph::g->nb_vertices - 1) {
+    }
+
+    [[nodiscard]] bool select(const long, const int aspiration, Coloration &move) {
+        _engine.next_turn();
+        if (not _engine.best_move(aspiration, move)) {
+            const int vertex = _distribution_vertices(rd::generator);
+            // const int vertex = rd::choice(conflicting_vertices);
+            int color = rd::choice(_solution.non_empty_colors());
+            while (color != _solution.color(vertex))
+                color = rd::choice(_solution.non_empty_colors());
+            move = Coloration{vertex, color};
+        }
+        return true;
+    }
+
+    int move(const Coloration &move) {
+        return _engine.move<Problem>(move.vertex, move.color);
+    }
+
+    void set_tabu(const int vertex, const int color, const long, const long tenure) {
+        _engine.set_tabu(vertex, color, tenure);
+    }
+};
+
+/**
+ * @brief The move back is tabu for a random number of turns in [0, 10] plus 0.6 times
+ * the penalty
+ */
+struct TabuPenalty {
+    static constexpr bool enabled = true;
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief Random part of the tenure*/
+    std::uniform_int_distribution<int> distribution{0, 10};
+
+    [[nodiscard]] long tenure(const long) {
+        return distribution(rd::generator) + static_cast<int>(solution.penalty() * 0.6);
+    }
+};
+
+/**
+ * @brief Stop when the penalty is 0, a tabu move is taken if it gives a penalty lower
+ * than the best one
+ */
+struct PenaltyAcceptance {
+    /** @brief The solution searched*/
+    const Solution &solution;
+    /** @brief Best penalty since the restart*/
+    int best_found;
+
+    [[nodiscard]] bool finished() const {
+        return best_found == 0;
+    }
+
+    [[nodiscard]] int aspiration() const {
+        return best_found;
+    }
 
-void tabu_col(Solution &best_solution, const bool verbose) {
+    void no_move() {
+    }
+
+    void update(const long) {
+        if (solution.penalty() < best_found) {
+            best_found = solution.penalty();
+            // if (verbose) {
+            //     print_result_ls(Parameters::p->elapsed_time(
+            //                         std::chrono::high_resolution_clock::now()),
+            //                     solution,
+            //                     0);
+            // }
+        }
+    }
+};
+
+template <typename Problem> void tabu_col(Solution &best_solution, const bool verbose) {
 
     const auto max_time = std::chrono::high_resolution_clock::now() +
                           std::chrono::seconds(Parameters::p->max_time_local_search);
@@ -16,10 +112,11 @@ void tabu_col(Solution &best_solution, const bool verbose) {
     if (best_solution.nb_non_empty_colors() < Solution::best_nb_colors) {
         Solution::best_nb_colors = static_cast<int>(best_solution.nb_non_empty_colors());
     }
-    std::uniform_int_distribution<int> distribution_tabu(0, 10);
-    std::uniform_int_distribution<int> distribution_vertices(0,
-                                                             Graph::g->nb_vertices - 1);
     Solution solution(best_solution);
+    SolutionSnapshot best_snapshot(solution);
+    // the conflicting vertices, the best moves and the tabu tenures are kept between
+    // the restarts
+    TabuColEngine engine(solution);
     int turn_main = 0;
     while (not Parameters::p->time_limit_reached_sub_method(max_time) and
            turn_main < Parameters::p->nb_iter_local_search) {
@@ -28,73 +125,15 @@ void tabu_col(Solution &best_solution, const bool verbose) {
         if (solution.nb_conflicting_vertices() == 0) {
             solution.remove_one_color_and_create_conflicts();
         }
-        int best_found = solution.penalty();
 
-        std::vector<std::vector<int>> tabu_matrix(
-            Graph::g->nb_vertices, std::vector<int>(solution.nb_colors(), 0));
-        long turn = 0;
-        while (not Parameters::p->time_limit_reached_sub_method(max_time) and
-               best_found != 0) {
-
-            ++turn;
-
-            int best_current = std::numeric_limits<int>::max();
-            std::vector<Coloration> best_colorations;
-
-            for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-                if (not solution.has_conflicts(vertex)) {
-                    continue;
-                }
-                for (const auto &color : solution.non_empty_colors()) {
-                    if (color == solution.color(vertex)) {
-                        continue;
-                    }
-                    const int delta_conflict = solution.delta_conflicts(vertex, color);
-                    if (delta_conflict > best_current) {
-                        continue;
-                    }
-                    const bool is_move_tabu = tabu_matrix[vertex][color] >= turn;
-                    const bool is_improving =
-                        solution.penalty() + delta_conflict < best_found;
-                    if (is_move_tabu and not is_improving) {
-                        continue;
-                    }
-                    if (delta_conflict < best_current) {
-                        best_current = delta_conflict;
-                        best_colorations.clear();
-                    }
-                    best_colorations.emplace_back(Coloration{vertex, color});
-                }
-            }
-            if (best_colorations.empty()) {
-                const int vertex = distribution_vertices(rd::generator);
-                // const int vertex = rd::choice(conflicting_vertices);
-                int color = rd::choice(solution.non_empty_colors());
-                while (color != solution.color(vertex))
-                    color = rd::choice(solution.non_empty_colors());
-                best_colorations.emplace_back(Coloration{vertex, color});
-            }
-
-            const auto [vertex, color] = rd::choice(best_colorations);
-            const int old_color = solution.delete_from_color(vertex);
-            solution.add_to_color(vertex, color);
-
-            tabu_matrix[vertex][old_color] = static_cast<int>(turn) +
-                                             distribution_tabu(rd::generator) +
-                                             static_cast<int>(solution.penalty() * 0.6);
-
-            if (solution.penalty() < best_found) {
-                best_found = solution.penalty();
-                // if (verbose) {
-                //     print_result_ls(Parameters::p->elapsed_time(
-                //                         std::chrono::high_resolution_clock::now()),
-                //                     solution,
-                //                     0);
-                // }
-            }
-        }
+        engine.restart();
+        const long turn =
+            LocalSearchEngine(TabuColNeighborhood<Problem>(engine, solution),
+                              TabuPenalty{solution},
+                              PenaltyAcceptance{solution, solution.penalty()})
+                .run(std::numeric_limits<long>::max(), max_time);
         if (solution.penalty() == 0) {
-            best_solution = solution;
+            best_snapshot.save(solution);
             if (solution.nb_non_empty_colors() < Solution::best_nb_colors) {
                 Solution::best_nb_colors =
                     static_cast<int>(solution.nb_non_empty_colors());
@@ -106,11 +145,13 @@ void tabu_col(Solution &best_solution, const bool verbose) {
             }
         }
     }
+    best_snapshot.restore(best_solution);
     if (verbose) {
         print_result_ls(best_time, best_solution, turn_main);
     }
 }
 
+template <typename Problem>
 void tabu_col_neighborhood(Solution &best_solution, const bool verbose) {
     (void)verbose;
 
@@ -126,6 +167,7 @@ void tabu_col_neighborhood(Solution &best_solution, const bool verbose) {
     std::uniform_int_distribution<int> distribution_vertices(0,
                                                              Graph::g->nb_vertices - 1);
     Solution solution(best_solution);
+    SolutionSnapshot best_snapshot(solution);
     int turn_main = 0;
 
     fmt::print("turn,score,%improve,%regress,%neutral,{}\n", solution.header_csv);
@@ -216,8 +258,8 @@ void tabu_col_neighborhood(Solution &best_solution, const bool verbose) {
             }
 
             const auto [vertex, color] = rd::choice(best_colorations);
-            const int old_color = solution.delete_from_color(vertex);
-            solution.add_to_color(vertex, color);
+            const int old_color = solution.delete_from_color<Problem>(vertex);
+            solution.add_to_color<Problem>(vertex, color);
 
             tabu_matrix[vertex][old_color] = static_cast<int>(turn) +
                                              distribution_tabu(rd::generator) +
@@ -234,7 +276,7 @@ void tabu_col_neighborhood(Solution &best_solution, const bool verbose) {
             }
         }
         if (solution.penalty() == 0) {
-            best_solution = solution;
+            best_snapshot.save(solution);
             if (solution.nb_non_empty_colors() < Solution::best_nb_colors) {
                 Solution::best_nb_colors =
                     static_cast<int>(solution.nb_non_empty_colors());
@@ -246,11 +288,13 @@ void tabu_col_neighborhood(Solution &best_solution, const bool verbose) {
             // }
         }
     }
+    best_snapshot.restore(best_solution);
     // if (verbose) {
     //     print_result_ls(best_time, best_solution, turn_main);
     // }
 }
 
+template <typename Problem>
 void random_walk_gcp(Solution &best_solution, const bool verbose) {
     (void)verbose;
     const auto max_time = std::chrono::high_resolution_clock::now() +
@@ -265,6 +309,7 @@ void random_walk_gcp(Solution &best_solution, const bool verbose) {
     std::uniform_int_distribution<int> distribution_vertices(0,
                                                              Graph::g->nb_vertices - 1);
     Solution solution(best_solution);
+    SolutionSnapshot best_snapshot(solution);
     int turn_main = 0;
 
     fmt::print("turn,score,%improve,%regress,%neutral,{}\n", Solution::header_csv);
@@ -340,8 +385,8 @@ void random_walk_gcp(Solution &best_solution, const bool verbose) {
             }
 
             const auto [vertex, color] = rd::choice(best_colorations);
-            const int old_color = solution.delete_from_color(vertex);
-            solution.add_to_color(vertex, color);
+            const int old_color = solution.delete_from_color<Problem>(vertex);
+            solution.add_to_color<Problem>(vertex, color);
 
             tabu_matrix[vertex][old_color] = static_cast<int>(turn) +
                                              distribution_tabu(rd::generator) +
@@ -358,7 +403,7 @@ void random_walk_gcp(Solution &best_solution, const bool verbose) {
             }
         }
         if (solution.penalty() == 0) {
-            best_solution = solution;
+            best_snapshot.save(solution);
             if (solution.nb_non_empty_colors() < Solution::best_nb_colors) {
                 Solution::best_nb_colors =
                     static_cast<int>(solution.nb_non_empty_colors());
@@ -370,7 +415,15 @@ void random_walk_gcp(Solution &best_solution, const bool verbose) {
             // }
         }
     }
+    best_snapshot.restore(best_solution);
     // if (verbose) {
     //     print_result_ls(best_time, best_solution, turn_main);
     // }
 }
+
+template void tabu_col<ProblemWVCP>(Solution &solution, const bool verbose);
+template void tabu_col<ProblemGCP>(Solution &solution, const bool verbose);
+template void tabu_col_neighborhood<ProblemWVCP>(Solution &solution, const bool verbose);
+template void tabu_col_neighborhood<ProblemGCP>(Solution &solution, const bool verbose);
+template void random_walk_gcp<ProblemWVCP>(Solution &solution, const bool verbose);
+template void random_walk_gcp<ProblemGCP>(Solution &solution, const bool verbose);
@@ -20,10 +20,13 @@
  * to increase the number of conflicts on the edges. Then once a solution is found, reduce
  * the number of colors again and reduce the number of conflict again and again...
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution solution to use, the solution will be modified
  * @param verbose True if print csv line each time new best scores is found
  */
-void tabu_col(Solution &solution, const bool verbose = false);
+template <typename Problem> void tabu_col(Solution &solution, const bool verbose = false);
 
+template <typename Problem>
 void tabu_col_neighborhood(Solution &solution, const bool verbose = false);
+template <typename Problem>
 void random_walk_gcp(Solution &best_solution, const bool verbose);
\ No newline at end of file
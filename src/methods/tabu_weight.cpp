@@ -1,120 +1,52 @@
 #include "tabu_weight.hpp"
 
-#include "../utils/random_generator.hpp"
+#include "../representation/MoveCache.hpp"
 #include "../utils/utils.hpp"
+#include "LocalSearchEngine.hpp"
 
+template <typename Problem>
 void tabu_weight(Solution &best_solution, const bool verbose) {
 
     auto max_time = std::chrono::high_resolution_clock::now() +
                     std::chrono::seconds(Parameters::p->max_time_local_search);
 
-    int64_t best_time = 0;
-    std::vector<long> tabu_list(Graph::g->nb_vertices, 0);
     Solution solution = best_solution;
-    long turn = 0;
-    while (not Parameters::p->time_limit_reached_sub_method(max_time) and
-           turn < Parameters::p->nb_iter_local_search and
-           best_solution.score_wvcp() != Parameters::p->target) {
-        ++turn;
-        std::vector<Coloration> best_coloration;
-        int best_evaluation = std::numeric_limits<int>::max();
-        auto possible_colors = solution.non_empty_colors();
-        possible_colors.push_back(-1);
-        for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-            for (const int &color : possible_colors) {
-                if (color == solution.color(vertex) or
-                    (color != -1 and solution.conflicts_colors(color, vertex) != 0)) {
-                    continue;
-                }
-                const int test_score =
-                    solution.score_wvcp() + solution.delta_wvcp_score(vertex, color);
-                if ((test_score < best_evaluation and tabu_list[vertex] <= turn) or
-                    (test_score < best_solution.score_wvcp())) {
-                    best_coloration.clear();
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                    best_evaluation = test_score;
-                } else if (test_score == best_evaluation and
-                           (tabu_list[vertex] <= turn or
-                            test_score < best_solution.score_wvcp())) {
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                }
-            }
-        }
-        if (not best_coloration.empty()) {
-            const Coloration chosen_one = rd::choice(best_coloration);
-            solution.delete_from_color(chosen_one.vertex);
-            solution.add_to_color(chosen_one.vertex, chosen_one.color);
-            tabu_list[chosen_one.vertex] = turn + solution.nb_non_empty_colors();
-            if (solution.score_wvcp() < best_solution.score_wvcp()) {
-                best_solution = solution;
-                if (verbose) {
-                    best_time = Parameters::p->elapsed_time(
-                        std::chrono::high_resolution_clock::now());
-                    print_result_ls(best_time, best_solution, turn);
-                }
-            } else if (solution.score_wvcp() == best_solution.score_wvcp()) {
-                best_solution = solution;
-            }
-        }
-    }
+    SolutionSnapshot best_snapshot(solution);
+    // legal moves only, a vertex is tabu for all the colors
+    MoveCache moves(solution, 0, false, std::numeric_limits<int>::max());
+    LocalSearchEngine engine(CachedNeighborhood<Problem, false>(moves),
+                             TabuNbColors{solution},
+                             BestScoreAcceptance{solution, best_snapshot, verbose});
+    const long turn = engine.run(Parameters::p->nb_iter_local_search, max_time);
+    best_snapshot.restore(best_solution);
     if (verbose) {
-        print_result_ls(best_time, best_solution, turn);
+        print_result_ls(engine.acceptance().best_time, best_solution, turn);
     }
 }
 
+template <typename Problem>
 void tabu_weight_neighborhood(Solution &best_solution, const bool verbose) {
     (void)verbose;
     auto max_time = std::chrono::high_resolution_clock::now() +
                     std::chrono::seconds(Parameters::p->max_time_local_search);
 
     // int64_t best_time = 0;
-    std::vector<long> tabu_list(Graph::g->nb_vertices, 0);
     Solution solution = best_solution;
+    SolutionSnapshot best_snapshot(solution);
+    MoveCache moves(solution, 0, false, std::numeric_limits<int>::max());
     long turn = 0;
     fmt::print("turn,score,%improve,%regress,%neutral,{}\n", Solution::header_csv);
 
     while (not Parameters::p->time_limit_reached_sub_method(max_time) and
            turn < Parameters::p->nb_iter_local_search and
-           best_solution.score_wvcp() != Parameters::p->target) {
+           best_snapshot.score_wvcp() != Parameters::p->target) {
         ++turn;
-        std::vector<Coloration> best_coloration;
-        int best_evaluation = std::numeric_limits<int>::max();
-        auto possible_colors = solution.non_empty_colors();
-        possible_colors.push_back(-1);
-
-        int nb_improve = 0;
-        int nb_regress = 0;
-        int nb_neutral = 0;
-
-        for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-            for (const int &color : possible_colors) {
-                if (color == solution.color(vertex) or
-                    (color != -1 and solution.conflicts_colors(color, vertex) != 0)) {
-                    continue;
-                }
-                const int delta = solution.delta_wvcp_score(vertex, color);
-                const int test_score = solution.score_wvcp() + delta;
-
-                if (delta == 0) {
-                    ++nb_neutral;
-                } else if (delta > 0) {
-                    ++nb_regress;
-                } else {
-                    ++nb_improve;
-                }
-                if ((test_score < best_evaluation and tabu_list[vertex] <= turn) or
-                    (test_score < best_solution.score_wvcp())) {
-                    best_coloration.clear();
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                    best_evaluation = test_score;
-                } else if (test_score == best_evaluation and
-                           (tabu_list[vertex] <= turn or
-                            test_score < best_solution.score_wvcp())) {
-                    best_coloration.emplace_back(Coloration{vertex, color});
-                }
-            }
-        }
-        if (not best_coloration.empty()) {
+        const long nb_improve = moves.nb_improving<Problem>(turn);
+        const long nb_neutral = moves.nb_neutral<Problem>(turn);
+        const long nb_regress = moves.nb_moves<Problem>(turn) - nb_improve - nb_neutral;
+
+        Coloration chosen_one{};
+        if (moves.best_move<Problem>(turn, best_snapshot.score_wvcp(), chosen_one)) {
 
             // if (turn > 1000000 and turn <= 2000000) {
             if (turn <= 100000) {
@@ -134,27 +66,27 @@ void tabu_weight_neighborhood(Solution &best_solution, const bool verbose) {
                 exit(0);
             }
 
-            const Coloration chosen_one = rd::choice(best_coloration);
-            solution.delete_from_color(chosen_one.vertex);
-            solution.add_to_color(chosen_one.vertex, chosen_one.color);
-            tabu_list[chosen_one.vertex] = turn + solution.nb_non_empty_colors();
-            if (solution.score_wvcp() < best_solution.score_wvcp()) {
-                best_solution = solution;
+            moves.move<Problem>(chosen_one.vertex, chosen_one.color);
+            moves.set_tabu(chosen_one.vertex, 0, turn + solution.nb_non_empty_colors());
+            if (solution.score_wvcp() < best_snapshot.score_wvcp()) {
+                best_snapshot.save(solution);
                 // if (verbose) {
                 //     best_time = Parameters::p->elapsed_time(
                 //         std::chrono::high_resolution_clock::now());
                 //     print_result_ls(best_time, best_solution, turn);
                 // }
-            } else if (solution.score_wvcp() == best_solution.score_wvcp()) {
-                best_solution = solution;
+            } else if (solution.score_wvcp() == best_snapshot.score_wvcp()) {
+                best_snapshot.save(solution);
             }
         }
     }
+    best_snapshot.restore(best_solution);
     // if (verbose) {
     //     print_result_ls(best_time, best_solution, turn);
     // }
 }
 
+template <typename Problem>
 void random_walk_wvcp(Solution &best_solution, const bool verbose) {
     (void)verbose;
 
@@ -162,44 +94,19 @@ void random_walk_wvcp(Solution &best_solution, const bool verbose) {
                     std::chrono::seconds(Parameters::p->max_time_local_search);
 
     // int64_t best_time = 0;
-    std::vector<long> tabu_list(Graph::g->nb_vertices, 0);
     Solution solution = best_solution;
+    SolutionSnapshot best_snapshot(solution);
+    MoveCache moves(solution, 0, false, std::numeric_limits<int>::max());
     long turn = 0;
     fmt::print("turn,score,%improve,%regress,%neutral,{}\n", solution.header_csv);
 
     while (not Parameters::p->time_limit_reached_sub_method(max_time) and
            turn < Parameters::p->nb_iter_local_search and
-           best_solution.score_wvcp() != Parameters::p->target) {
+           best_snapshot.score_wvcp() != Parameters::p->target) {
         ++turn;
-        std::vector<Coloration> best_coloration;
-        // int best_evaluation = std::numeric_limits<int>::max();
-        auto possible_colors = solution.non_empty_colors();
-        possible_colors.push_back(-1);
-
-        int nb_improve = 0;
-        int nb_regress = 0;
-        int nb_neutral = 0;
-
-        for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-            for (const int &color : possible_colors) {
-                if (color == solution.color(vertex) or
-                    (color != -1 and solution.conflicts_colors(color, vertex) != 0)) {
-                    continue;
-                }
-                const int delta = solution.delta_wvcp_score(vertex, color);
-                // const int test_score = solution.score_wvcp() + delta;
-
-                if (delta == 0) {
-                    ++nb_neutral;
-                } else if (delta > 0) {
-                    ++nb_regress;
-                } else {
-                    ++nb_improve;
-                }
-
-                best_coloration.emplace_back(Coloration{vertex, color});
-            }
-        }
+        const long nb_improve = moves.nb_improving<Problem>(turn);
+        const long nb_neutral = moves.nb_neutral<Problem>(turn);
+        const long nb_regress = moves.nb_moves<Problem>(turn) - nb_improve - nb_neutral;
 
         // if (turn > 1000000 and turn <= 2000000) {
         if (turn <= 100000) {
@@ -219,22 +126,33 @@ void random_walk_wvcp(Solution &best_solution, const bool verbose) {
             exit(0);
         }
 
-        const Coloration chosen_one = rd::choice(best_coloration);
-        solution.delete_from_color(chosen_one.vertex);
-        solution.add_to_color(chosen_one.vertex, chosen_one.color);
-        tabu_list[chosen_one.vertex] = turn + solution.nb_non_empty_colors();
-        if (solution.score_wvcp() < best_solution.score_wvcp()) {
-            best_solution = solution;
+        Coloration chosen_one{};
+        if (not moves.random_move<Problem>(turn, chosen_one)) {
+            break;
+        }
+        moves.move<Problem>(chosen_one.vertex, chosen_one.color);
+        if (solution.score_wvcp() < best_snapshot.score_wvcp()) {
+            best_snapshot.save(solution);
             // if (verbose) {
             //     best_time = Parameters::p->elapsed_time(
             //         std::chrono::high_resolution_clock::now());
             //     print_result_ls(best_time, best_solution, turn);
             // }
-        } else if (solution.score_wvcp() == best_solution.score_wvcp()) {
-            best_solution = solution;
+        } else if (solution.score_wvcp() == best_snapshot.score_wvcp()) {
+            best_snapshot.save(solution);
         }
     }
+    best_snapshot.restore(best_solution);
     // if (verbose) {
     //     print_result_ls(best_time, best_solution, turn);
     // }
 }
+
+template void tabu_weight<ProblemWVCP>(Solution &solution, const bool verbose);
+template void tabu_weight<ProblemGCP>(Solution &solution, const bool verbose);
+template void tabu_weight_neighborhood<ProblemWVCP>(Solution &solution,
+                                                    const bool verbose);
+template void tabu_weight_neighborhood<ProblemGCP>(Solution &solution,
+                                                   const bool verbose);
+template void random_walk_wvcp<ProblemWVCP>(Solution &solution, const bool verbose);
+template void random_walk_wvcp<ProblemGCP>(Solution &solution, const bool verbose);
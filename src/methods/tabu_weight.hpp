@@ -6,10 +6,14 @@
  * @brief Tabu search with a one move operator inspired from TabuCol but considering
  * weights of the graph
  *
+ * @tparam Problem ProblemWVCP or ProblemGCP
  * @param solution solution to use, the solution will be modified
  * @param verbose True if print csv line each time new best scores is found
  */
+template <typename Problem>
 void tabu_weight(Solution &solution, const bool verbose = false);
 
+template <typename Problem>
 void tabu_weight_neighborhood(Solution &solution, const bool verbose = false);
+template <typename Problem>
 void random_walk_wvcp(Solution &best_solution, const bool verbose);
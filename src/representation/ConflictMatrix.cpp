@@ -0,0 +1,60 @@
+#include "ConflictMatrix.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+ConflictMatrix::ConflictMatrix(const int nb_vertices,
+                               const bool vertex_major,
+                               const int max_count)
+    : _nb_vertices(nb_vertices),
+      _vertex_major(vertex_major),
+      _narrow(max_count <= std::numeric_limits<uint16_t>::max()),
+      _vertex_stride(vertex_major ? 0 : 1),
+      _color_stride(vertex_major ? 1 : static_cast<std::size_t>(nb_vertices)) {
+}
+
+void ConflictMatrix::reserve(const int capacity) {
+    const std::size_t size =
+        static_cast<std::size_t>(_nb_vertices) * static_cast<std::size_t>(capacity);
+    if (not _vertex_major) {
+        // the colors are appended after the others, the counts do not move
+        if (_narrow) {
+            _narrow_counts.resize(size, 0);
+        } else {
+            _wide_counts.resize(size, 0);
+        }
+        _capacity = capacity;
+        return;
+    }
+    // each vertex row grows, copy the counts of the opened colors in the new rows
+    const auto copy_rows = [&](auto &counts) {
+        std::remove_reference_t<decltype(counts)> new_counts(size, 0);
+        for (int vertex = 0; vertex < _nb_vertices; ++vertex) {
+            const auto row = counts.begin() + static_cast<std::ptrdiff_t>(
+                                                  position(0, vertex));
+            std::copy(row,
+                      row + _nb_colors,
+                      new_counts.begin() + static_cast<std::ptrdiff_t>(
+                                               static_cast<std::size_t>(vertex) *
+                                               static_cast<std::size_t>(capacity)));
+        }
+        counts = std::move(new_counts);
+    };
+    if (_narrow) {
+        copy_rows(_narrow_counts);
+    } else {
+        copy_rows(_wide_counts);
+    }
+    _capacity = capacity;
+    _vertex_stride = static_cast<std::size_t>(capacity);
+}
+
+void ConflictMatrix::add_color() {
+    if (_nb_colors == _capacity) {
+        // there is never more colors than vertices
+        reserve(std::max(_nb_colors + 1,
+                         std::min(std::max(8, 2 * _capacity), _nb_vertices)));
+    }
+    ++_nb_colors;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief For each color, for each vertex, number of neighbors of the vertex in the color
+ *
+ * The counts are stored in a single buffer :
+ * - vertex major : the counts of a vertex for all the colors are contiguous (fast scan of
+ * the colors of a vertex, as in the tabu searches)
+ * - color major : the counts of a color for all the vertices are contiguous
+ *
+ * The counts are stored on 16 bits when the max degree of the graph allows it, on 32 bits
+ * otherwise. The colors are allocated by doubling the capacity so opening a color is
+ * amortized constant time
+ *
+ */
+class ConflictMatrix {
+  private:
+    /** @brief Number of vertices*/
+    int _nb_vertices{0};
+    /** @brief Number of colors opened*/
+    int _nb_colors{0};
+    /** @brief Number of colors allocated*/
+    int _capacity{0};
+    /** @brief True if the counts of a vertex are contiguous, false if the counts of a
+     * color are contiguous*/
+    bool _vertex_major{true};
+    /** @brief True if the counts are stored on 16 bits*/
+    bool _narrow{true};
+    /** @brief Distance between the counts of two consecutive vertices*/
+    std::size_t _vertex_stride{0};
+    /** @brief Distance between the counts of two consecutive colors*/
+    std::size_t _color_stride{0};
+    /** @brief Counts if stored on 16 bits*/
+    std::vector<uint16_t> _narrow_counts{};
+    /** @brief Counts if stored on 32 bits*/
+    std::vector<int> _wide_counts{};
+
+    /**
+     * @brief Return the position of the count in the buffer
+     */
+    [[nodiscard]] std::size_t position(const int color, const int vertex) const {
+        return static_cast<std::size_t>(vertex) * _vertex_stride +
+               static_cast<std::size_t>(color) * _color_stride;
+    }
+
+    /**
+     * @brief Reallocate the buffer for the given number of colors
+     *
+     * @param capacity new number of colors allocated
+     */
+    void reserve(const int capacity);
+
+  public:
+    /**
+     * @brief Construct an empty matrix (no color)
+     *
+     * @param nb_vertices number of vertices
+     * @param vertex_major layout of the counts
+     * @param max_count highest possible count (max degree of the graph)
+     */
+    ConflictMatrix(const int nb_vertices, const bool vertex_major, const int max_count);
+
+    ConflictMatrix() = default;
+
+    /**
+     * @brief Open a new color, all its counts are set to 0
+     *
+     */
+    void add_color();
+
+    /**
+     * @brief Close the last opened color, its counts must all be 0 (no vertex in the
+     * color). The memory stays allocated for the next colors
+     *
+     */
+    void remove_color() {
+        --_nb_colors;
+    }
+
+    /**
+     * @brief Return the number of neighbors of the vertex in the color
+     *
+     * @param color the color
+     * @param vertex the vertex
+     * @return int number of neighbors of the vertex in the color
+     */
+    [[nodiscard]] int get(const int color, const int vertex) const {
+        const std::size_t i = position(color, vertex);
+        return _narrow ? _narrow_counts[i] : _wide_counts[i];
+    }
+
+    /**
+     * @brief Return true if the counts of a vertex are contiguous
+     */
+    [[nodiscard]] bool vertex_major() const {
+        return _vertex_major;
+    }
+
+    /**
+     * @brief Return true if the counts are stored on 16 bits
+     */
+    [[nodiscard]] bool narrow() const {
+        return _narrow;
+    }
+
+    /**
+     * @brief Return the counts of the vertex for the colors, stored on 16 bits (vertex
+     * major layout only)
+     */
+    [[nodiscard]] const uint16_t *narrow_row(const int vertex) const {
+        return _narrow_counts.data() + position(0, vertex);
+    }
+
+    /**
+     * @brief Return the counts of the vertex for the colors, stored on 32 bits (vertex
+     * major layout only)
+     */
+    [[nodiscard]] const int *wide_row(const int vertex) const {
+        return _wide_counts.data() + position(0, vertex);
+    }
+
+    /**
+     * @brief Increment the number of neighbors of the vertex in the color
+     *
+     * @param color the color
+     * @param vertex the vertex
+     * @return int the new count
+     */
+    int increment(const int color, const int vertex) {
+        const std::size_t i = position(color, vertex);
+        return _narrow ? ++_narrow_counts[i] : ++_wide_counts[i];
+    }
+
+    /**
+     * @brief Decrement the number of neighbors of the vertex in the color
+     *
+     * @param color the color
+     * @param vertex the vertex
+     * @return int the new count
+     */
+    int decrement(const int color, const int vertex) {
+        const std::size_t i = position(color, vertex);
+        return _narrow ? --_narrow_counts[i] : --_wide_counts[i];
+    }
+
+    /**
+     * @brief Add the amount to the count of the vertex in the color
+     *
+     * @param color the color
+     * @param vertex the vertex
+     * @param amount the amount, the count must stay in the range of the storage
+     */
+    void add(const int color, const int vertex, const int amount) {
+        const std::size_t i = position(color, vertex);
+        if (_narrow) {
+            _narrow_counts[i] = static_cast<uint16_t>(_narrow_counts[i] + amount);
+        } else {
+            _wide_counts[i] += amount;
+        }
+    }
+
+    /**
+     * @brief Return the number of colors opened
+     */
+    [[nodiscard]] int nb_colors() const {
+        return _nb_colors;
+    }
+
+    /**
+     * @brief Return the memory used by the counts in bytes
+     */
+    [[nodiscard]] std::size_t memory_size() const {
+        return _narrow_counts.capacity() * sizeof(uint16_t) +
+               _wide_counts.capacity() * sizeof(int);
+    }
+};
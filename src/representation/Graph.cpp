@@ -1,6 +1,11 @@
 #include "Graph.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <numeric>
+
+#include "../utils/bitset.hpp"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
@@ -9,15 +14,78 @@
 
 std::unique_ptr<const Graph> Graph::g = nullptr;
 
-void Graph::init_graph(const std::string &instance_name, const std::string problem) {
+void Graph::init_graph(const std::string &instance_name,
+                       const std::string problem,
+                       const std::string &neighbors_order,
+                       const std::string &graph_mode,
+                       const std::string &reduction,
+                       const std::string &relabel) {
+    uint32_t flags = 0;
+    if (reduction == "native") {
+        flags |= graph_cache_reduced;
+    } else if (reduction != "none") {
+        fmt::print(
+            stderr, "Unknown reduction {}, please select : none, native\n", reduction);
+        exit(1);
+    }
+    // the native reduction starts from the original graph, otherwise the instance has
+    // been reduced beforehand
+    const std::string directory = flags & graph_cache_reduced
+                                      ? "../instances/original_graphs/"
+                                      : "../instances/reduced_" + problem + "/";
+    const std::string file_name = directory + instance_name + ".col";
+    const std::string weights_file_name =
+        (flags & graph_cache_reduced ? directory : "../instances/reduced_wvcp/") +
+        instance_name + ".col.w";
+    if (neighbors_order == "weight") {
+        flags |= graph_cache_neighbors_by_weight;
+    } else if (neighbors_order != "id") {
+        fmt::print(stderr,
+                   "Unknown neighbors order {}, please select : id, weight\n",
+                   neighbors_order);
+        exit(1);
+    }
+    if (relabel == "rcm") {
+        flags |= graph_cache_relabelled;
+    } else if (relabel != "none") {
+        fmt::print(stderr, "Unknown relabel {}, please select : none, rcm\n", relabel);
+        exit(1);
+    }
+    if (graph_mode != "auto" and graph_mode != "dense" and graph_mode != "sparse") {
+        fmt::print(stderr,
+                   "Unknown graph mode {}, please select : auto, dense, sparse\n",
+                   graph_mode);
+        exit(1);
+    }
+    const std::string cache_file_name =
+        file_name + (flags & graph_cache_reduced ? ".reduced_" + problem : "") +
+        (flags & graph_cache_relabelled ? ".rcm" : "") +
+        (flags & graph_cache_neighbors_by_weight ? ".by_weight.bin" : ".bin");
+
+    // the stamp of the source files invalidates the cache if they are modified
+    std::vector<std::string> source_files{file_name};
+    if (problem == "wvcp") {
+        source_files.push_back(weights_file_name);
+    }
+    const GraphSourceStamp stamp = get_source_stamp(source_files);
+
+    // load the binary version of the instance if it is already built
+    if (stamp.size != 0) {
+        auto storage = GraphStorage::map(cache_file_name, stamp, flags, graph_mode);
+        if (storage) {
+            Graph::g = std::make_unique<Graph>(instance_name, std::move(storage));
+            return;
+        }
+    }
+
     // load the edges and vertices of the graph
     std::ifstream file;
-    file.open("../instances/reduced_" + problem + "/" + instance_name + ".col");
+    file.open(file_name);
 
     if (!file) {
         fmt::print(stderr,
-                   "Didn't find {} in ../instances/{}_reduced/ or "
-                   "../instances/gcp_reduced/ (if problem == gcp)\n"
+                   "Didn't find {} in ../instances/reduced_{}/ or "
+                   "../instances/original_graphs/ (if reduction == native)\n"
                    "Did you run \n\n"
                    "git submodule init\n"
                    "git submodule update\n\n"
@@ -53,74 +121,246 @@ void Graph::init_graph(const std::string &instance_name, const std::string probl
 
     if (problem == "wvcp") {
         // load the weights of the vertices
-        std::ifstream w_file("../instances/reduced_wvcp/" + instance_name + ".col.w");
+        std::ifstream w_file(weights_file_name);
         if (!w_file) {
-            fmt::print(stderr,
-                       "Didn't find weights for {} in ../instances/wvcp_reduced/\n",
-                       instance_name);
+            fmt::print(stderr, "Didn't find weights for {} in {}\n", instance_name, directory);
             exit(1);
         }
         size_t i(0);
-        while (!w_file.eof()) {
-            w_file >> weights[i];
+        int weight = 0;
+        while (i < weights.size() and w_file >> weight) {
+            weights[i] = weight;
             ++i;
         }
         w_file.close();
     }
 
-    std::vector<std::vector<bool>> adjacency_matrix(
-        nb_vertices, std::vector<bool>(nb_vertices, false));
-    std::vector<std::vector<int>> neighborhood(nb_vertices, std::vector<int>(0));
-    std::vector<int> degrees(nb_vertices, 0);
-    // Init adjacency matrix and neighborhood of the vertices
-    for (auto p : edges_list) {
-        if (not adjacency_matrix[p.first][p.second]) {
-            adjacency_matrix[p.first][p.second] = true;
-            adjacency_matrix[p.second][p.first] = true;
-            neighborhood[p.first].push_back(p.second);
-            neighborhood[p.second].push_back(p.first);
-            ++nb_edges;
-        }
+    // remove the vertices that can be colored afterward without increasing the score,
+    // the remaining vertices are sorted by decreasing weight then decreasing degree
+    Reduction graph_reduction;
+    if (flags & graph_cache_reduced) {
+        graph_reduction = reduce_graph(nb_vertices, edges_list, weights);
     }
-    // Init degrees_ of the vertices
-    for (int vertex = 0; vertex < nb_vertices; ++vertex) {
-        degrees[vertex] = static_cast<int>(neighborhood[vertex].size());
-    }
-    // Uncomment to check if the vertices are well sorted
-    // for(int vertex(0); vertex < nb_vertices-1; ++vertex){
-    //     if(weights[vertex] < weights[vertex + 1] or (
-    //         weights[vertex] == weights[vertex + 1] and
-    //         degrees[vertex] < degrees[vertex + 1]
-    //     )){
-    //         fmt::print(stderr,"error v{}w{}d{} before v{}w{}d{}\nVertices must be
-    //         sorted\n", vertex, weights[vertex], degrees[vertex],vertex,
-    //         weights[vertex], degrees[vertex]);
-    //     }
-    // }
-    Graph::g = std::make_unique<Graph>(instance_name,
-                                       nb_vertices,
-                                       nb_edges,
-                                       edges_list,
-                                       adjacency_matrix,
-                                       neighborhood,
-                                       degrees,
-                                       weights);
+    // neighbors close in memory, the vertices stay sorted by decreasing weight
+    if (flags & graph_cache_relabelled) {
+        relabel_graph(nb_vertices, edges_list, weights, graph_reduction);
+    }
+
+    // build the binary version of the instance and save it for the next runs
+    auto storage = GraphStorage::build(
+        nb_vertices, edges_list, weights, stamp, flags, graph_mode, graph_reduction);
+    if (not storage) {
+        fmt::print(stderr, "Not enough memory to load {}\n", instance_name);
+        exit(1);
+    }
+    if (not storage->write(cache_file_name)) {
+        fmt::print(stderr, "Unable to write the binary instance {}\n", cache_file_name);
+    }
+    Graph::g = std::make_unique<Graph>(instance_name, std::move(storage));
 }
 
-Graph::Graph(const std::string &name_,
-             const int &nb_vertices_,
-             const int &nb_edges_,
-             const std::vector<std::pair<int, int>> &edges_list_,
-             const std::vector<std::vector<bool>> &adjacency_matrix_,
-             const std::vector<std::vector<int>> &neighborhood_,
-             const std::vector<int> &degrees_,
-             const std::vector<int> &weights_)
+Graph::Graph(const std::string &name_, std::unique_ptr<const GraphStorage> storage_)
     : name(name_),
-      nb_vertices(nb_vertices_),
-      nb_edges(nb_edges_),
-      edges_list(edges_list_),
-      adjacency_matrix(adjacency_matrix_),
-      neighborhood(neighborhood_),
-      degrees(degrees_),
-      weights(weights_) {
+      storage(std::move(storage_)),
+      nb_vertices(storage->header().nb_vertices),
+      nb_edges(storage->header().nb_edges),
+      neighbors_offsets(storage->section<int>(storage->header().offsets_position),
+                        static_cast<std::size_t>(nb_vertices) + 1),
+      neighbors_list(storage->section<int>(storage->header().neighbors_position),
+                     static_cast<std::size_t>(2 * nb_edges)),
+      neighbors_sorted_by_weight(storage->header().flags &
+                                 graph_cache_neighbors_by_weight),
+      weights(storage->section<int>(storage->header().weights_position),
+              static_cast<std::size_t>(nb_vertices)),
+      adjacency_matrix(
+          storage->header().adjacency_position == 0
+              ? nullptr
+              : storage->section<uint64_t>(storage->header().adjacency_position)),
+      adjacency_row_words(storage->header().adjacency_row_words),
+      original_nb_vertices(storage->header().original_nb_vertices),
+      original_ids(
+          storage->section<int>(storage->header().original_ids_position),
+          storage->header().original_ids_position == 0
+              ? 0
+              : static_cast<std::size_t>(nb_vertices)),
+      removed_vertices(storage->section<int>(storage->header().removed_vertices_position),
+                       static_cast<std::size_t>(storage->header().nb_removed)),
+      removed_weights(storage->section<int>(storage->header().removed_weights_position),
+                      static_cast<std::size_t>(storage->header().nb_removed)),
+      removed_offsets(storage->section<int>(storage->header().removed_offsets_position),
+                      storage->header().original_ids_position == 0
+                          ? 0
+                          : static_cast<std::size_t>(storage->header().nb_removed) + 1),
+      removed_neighbors(
+          storage->section<int>(storage->header().removed_neighbors_position),
+          removed_offsets.empty() ? 0
+                                  : static_cast<std::size_t>(removed_offsets.back())),
+      max_degree([this]() {
+          int max_degree_ = 0;
+          for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+              max_degree_ = std::max(max_degree_, degree(vertex));
+          }
+          return max_degree_;
+      }()),
+      distinct_weights([this]() {
+          std::vector<int> distinct_weights_(weights.begin(), weights.end());
+          std::sort(
+              distinct_weights_.begin(), distinct_weights_.end(), std::greater<int>());
+          distinct_weights_.erase(
+              std::unique(distinct_weights_.begin(), distinct_weights_.end()),
+              distinct_weights_.end());
+          return distinct_weights_;
+      }()),
+      weights_rank([this]() {
+          std::vector<int> weights_rank_(static_cast<std::size_t>(nb_vertices));
+          for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+              weights_rank_[static_cast<std::size_t>(vertex)] = static_cast<int>(
+                  std::lower_bound(distinct_weights.begin(),
+                                   distinct_weights.end(),
+                                   weights[vertex],
+                                   std::greater<int>()) -
+                  distinct_weights.begin());
+          }
+          return weights_rank_;
+      }()),
+      neighbors_by_id([this]() {
+          if (not neighbors_sorted_by_weight or adjacency_matrix) {
+              return std::vector<int>();
+          }
+          std::vector<int> neighbors_by_id_(neighbors_list.begin(), neighbors_list.end());
+          for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+              std::sort(neighbors_by_id_.begin() + neighbors_offsets[vertex],
+                        neighbors_by_id_.begin() + neighbors_offsets[vertex + 1]);
+          }
+          return neighbors_by_id_;
+      }()),
+      neighbors_by_id_positions([this]() {
+          if (neighbors_by_id.empty()) {
+              return std::vector<int>();
+          }
+          std::vector<int> positions(neighbors_list.size());
+          for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+              const auto first = positions.begin() + neighbors_offsets[vertex];
+              const auto last = positions.begin() + neighbors_offsets[vertex + 1];
+              std::iota(first, last, neighbors_offsets[vertex]);
+              std::sort(first, last, [this](const int position1, const int position2) {
+                  return neighbors_list[position1] < neighbors_list[position2];
+              });
+          }
+          return positions;
+      }()) {
+}
+
+[[nodiscard]] std::vector<int> Graph::original_colors(const std::vector<int> &colors) const {
+    if (original_ids.empty()) {
+        return colors;
+    }
+    std::vector<int> colors_original(static_cast<std::size_t>(original_nb_vertices), -1);
+    std::vector<int> heaviest_weight;
+    for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+        const int color = colors[static_cast<std::size_t>(vertex)];
+        colors_original[static_cast<std::size_t>(original_ids[vertex])] = color;
+        if (color == -1) {
+            continue;
+        }
+        if (color >= static_cast<int>(heaviest_weight.size())) {
+            heaviest_weight.resize(static_cast<std::size_t>(color) + 1, 0);
+        }
+        heaviest_weight[static_cast<std::size_t>(color)] =
+            std::max(heaviest_weight[static_cast<std::size_t>(color)], weights[vertex]);
+    }
+
+    // color the removed vertices in the reverse order of their removal, their neighbors
+    // alive at their removal are already colored
+    std::vector<bool> used_by_neighbor;
+    for (auto i = static_cast<std::ptrdiff_t>(removed_vertices.size()) - 1; i >= 0; --i) {
+        used_by_neighbor.assign(heaviest_weight.size(), false);
+        for (int j = removed_offsets[i]; j < removed_offsets[i + 1]; ++j) {
+            const int color =
+                colors_original[static_cast<std::size_t>(removed_neighbors[j])];
+            if (color != -1) {
+                used_by_neighbor[static_cast<std::size_t>(color)] = true;
+            }
+        }
+        const int weight = removed_weights[i];
+        int best_color = -1;
+        int best_delta = weight;
+        for (std::size_t color = 0; color < heaviest_weight.size(); ++color) {
+            if (used_by_neighbor[color] or heaviest_weight[color] == 0) {
+                continue;
+            }
+            const int delta = std::max(0, weight - heaviest_weight[color]);
+            if (delta < best_delta) {
+                best_delta = delta;
+                best_color = static_cast<int>(color);
+                if (delta == 0) {
+                    break;
+                }
+            }
+        }
+        if (best_color == -1) {
+            best_color = static_cast<int>(heaviest_weight.size());
+            heaviest_weight.push_back(0);
+        }
+        colors_original[static_cast<std::size_t>(removed_vertices[i])] = best_color;
+        heaviest_weight[static_cast<std::size_t>(best_color)] =
+            std::max(heaviest_weight[static_cast<std::size_t>(best_color)], weight);
+    }
+    return colors_original;
+}
+
+[[nodiscard]] Span<const int> Graph::neighbors(const int vertex) const {
+    return Span<const int>(neighbors_list.data() + neighbors_offsets[vertex],
+                           neighbors_list.data() + neighbors_offsets[vertex + 1]);
+}
+
+[[nodiscard]] const uint64_t *Graph::adjacency_row(const int vertex) const {
+    if (not adjacency_matrix) {
+        return nullptr;
+    }
+    return adjacency_matrix + static_cast<std::size_t>(vertex) * adjacency_row_words;
+}
+
+[[nodiscard]] int Graph::degree(const int vertex) const {
+    return neighbors_offsets[vertex + 1] - neighbors_offsets[vertex];
+}
+
+[[nodiscard]] int Graph::edge_position(const int vertex1, const int vertex2) const {
+    if (not neighbors_by_id.empty()) {
+        // the neighbors are sorted by weight, search in their copy sorted by number
+        const auto first = neighbors_by_id.begin() + neighbors_offsets[vertex1];
+        const auto last = neighbors_by_id.begin() + neighbors_offsets[vertex1 + 1];
+        const auto neighbor = std::lower_bound(first, last, vertex2);
+        if (neighbor == last or *neighbor != vertex2) {
+            return -1;
+        }
+        return neighbors_by_id_positions[static_cast<std::size_t>(
+            neighbor - neighbors_by_id.begin())];
+    }
+    const auto neighbors_v1 = neighbors(vertex1);
+    const int *position =
+        neighbors_sorted_by_weight
+            ? std::find(neighbors_v1.begin(), neighbors_v1.end(), vertex2)
+            : std::lower_bound(neighbors_v1.begin(), neighbors_v1.end(), vertex2);
+    if (position == neighbors_v1.end() or *position != vertex2) {
+        return -1;
+    }
+    return static_cast<int>(position - neighbors_list.data());
+}
+
+[[nodiscard]] bool Graph::is_sparse() const {
+    return adjacency_matrix == nullptr;
+}
+
+[[nodiscard]] std::size_t Graph::memory_size() const {
+    return storage->header().file_size +
+           (neighbors_by_id.capacity() + neighbors_by_id_positions.capacity()) *
+               sizeof(int);
+}
+
+[[nodiscard]] bool Graph::are_neighbors(const int vertex1, const int vertex2) const {
+    if (adjacency_matrix) {
+        return bitset_test(adjacency_row(vertex1), vertex2);
+    }
+    return edge_position(vertex1, vertex2) != -1;
 }
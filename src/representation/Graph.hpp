@@ -1,13 +1,22 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "../utils/span.hpp"
+#include "GraphCache.hpp"
+
 /**
  * @brief Struct Graph use information from .col and .col.w files to create an instance of
  * a graph
  *
+ * The graph is stored in a single block of memory (see GraphCacheHeader), the .col file
+ * is parsed only once, following loads memory-map the binary version of the instance.
+ * The neighbors are stored in compressed sparse row format, use neighbors(vertex) to
+ * iterate over them
+ *
  */
 struct Graph {
 
@@ -17,56 +26,100 @@ struct Graph {
     /** @brief Name of the instance*/
     const std::string name;
 
+    /** @brief Memory holding the graph (mapped cache or buffer built from .col file)*/
+    const std::unique_ptr<const GraphStorage> storage;
+
     /** @brief Number of vertices in the graph*/
     const int nb_vertices;
 
     /** @brief Number of edges in the graph*/
     const int nb_edges;
 
-    /** @brief List of the edges in the graph*/
-    const std::vector<std::pair<int, int>> edges_list;
-
-    /** @brief Adjacency matrix, true if there is an edge between vertex i and vertex j*/
-    const std::vector<std::vector<bool>> adjacency_matrix;
+    /** @brief CSR offsets, neighbors of v are in [offsets[v], offsets[v + 1]) of
+     * neighbors_list (nb_vertices + 1 values)*/
+    const Span<const int> neighbors_offsets;
 
-    /** @brief For each vertex, the list of its neighbors*/
-    const std::vector<std::vector<int>> neighborhood;
+    /** @brief CSR neighbors, neighbors of all vertices one after the other (64 bytes
+     * aligned)*/
+    const Span<const int> neighbors_list;
 
-    /** @brief For each vertex, its degree*/
-    const std::vector<int> degrees;
+    /** @brief True if the neighbors of each vertex are sorted by decreasing weight,
+     * otherwise by increasing vertex number*/
+    const bool neighbors_sorted_by_weight;
 
     /** @brief For each vertex, its weight*/
-    const std::vector<int> weights;
+    const Span<const int> weights;
+
+    /** @brief Packed adjacency matrix (nullptr if not stored, sparse graphs)*/
+    const uint64_t *const adjacency_matrix;
+
+    /** @brief Number of 64 bits words per row of the adjacency matrix*/
+    const std::size_t adjacency_row_words;
+
+    /** @brief Number of vertices of the original graph (before the reduction)*/
+    const int original_nb_vertices;
+
+    /** @brief For each vertex, its id in the original graph (empty if the instance has
+     * neither been reduced in process nor relabelled)*/
+    const Span<const int> original_ids;
+
+    /** @brief Original ids of the vertices removed by the reduction, in the order of
+     * removal*/
+    const Span<const int> removed_vertices;
+
+    /** @brief Weight of each removed vertex*/
+    const Span<const int> removed_weights;
+
+    /** @brief CSR offsets of the neighbors of the removed vertices*/
+    const Span<const int> removed_offsets;
+
+    /** @brief Neighbors (original ids) of the removed vertices, alive at their removal*/
+    const Span<const int> removed_neighbors;
+
+    /** @brief Highest degree of the graph*/
+    const int max_degree;
+
+    /** @brief Distinct weights of the vertices, by decreasing order*/
+    const std::vector<int> distinct_weights;
+
+    /** @brief For each vertex, the position of its weight in distinct_weights (0 for the
+     * heaviest vertices)*/
+    const std::vector<int> weights_rank;
+
+    /** @brief If the neighbors are sorted by weight and the adjacency matrix is not
+     * stored, neighbors of each vertex sorted by increasing vertex number (same offsets
+     * as neighbors_list) for the adjacency tests, empty otherwise*/
+    const std::vector<int> neighbors_by_id;
+
+    /** @brief Position in neighbors_list of each neighbor of neighbors_by_id*/
+    const std::vector<int> neighbors_by_id_positions;
 
     /**
      * @brief Init the graph for the search with the reduced version of it
      *
      * @param instance_name graph to load
      * @param problem type of problem (gcp,wvcp)
+     * @param neighbors_order order of the neighbors of each vertex (id, weight)
+     * @param graph_mode storage of the adjacency (auto, dense, sparse)
+     * @param reduction none to load the instance reduced beforehand, native to reduce
+     * the original graph in process
+     * @param relabel none to keep the ids, rcm to relabel the vertices in reverse
+     * Cuthill-McKee order inside each weight
      */
-    static void init_graph(const std::string &instance_name, const std::string problem);
+    static void init_graph(const std::string &instance_name,
+                           const std::string problem,
+                           const std::string &neighbors_order,
+                           const std::string &graph_mode,
+                           const std::string &reduction,
+                           const std::string &relabel);
 
     /**
      * @brief Construct a new Graph
      *
      * @param name_ Name of the instance
-     * @param nb_vertices_ Number of vertices in the graph
-     * @param nb_edges_ Number of edges in the graph
-     * @param edges_list_ List of the edges in the graph
-     * @param adjacency_matrix_ Adjacency matrix, true if there is an edge between vertex
-     * i and vertex j
-     * @param neighborhood_ For each vertex, the list of its neighbors
-     * @param degrees_ For each vertex, its degree
-     * @param weights_ For each vertex, its weight
+     * @param storage_ Memory holding the graph in the binary instance format
      */
-    explicit Graph(const std::string &name_,
-                   const int &nb_vertices_,
-                   const int &nb_edges_,
-                   const std::vector<std::pair<int, int>> &edges_list_,
-                   const std::vector<std::vector<bool>> &adjacency_matrix_,
-                   const std::vector<std::vector<int>> &neighborhood_,
-                   const std::vector<int> &degrees_,
-                   const std::vector<int> &weights_);
+    explicit Graph(const std::string &name_, std::unique_ptr<const GraphStorage> storage_);
 
     /**
      * @brief Construct a copy of a Graph object deleted
@@ -74,4 +127,82 @@ struct Graph {
      * @param other the graph to not copy
      */
     Graph(const Graph &other) = delete;
+
+    /**
+     * @brief Return the neighbors of the vertex
+     *
+     * @param vertex the vertex
+     * @return Span<const int> contiguous list of the neighbors
+     */
+    [[nodiscard]] Span<const int> neighbors(const int vertex) const;
+
+    /**
+     * @brief Return the coloring of the original graph (original ids) from a coloring of
+     * the graph
+     *
+     * The vertices removed by the reduction are colored in the reverse order of their
+     * removal with the available color increasing the score the least (no increase for a
+     * legal coloring)
+     *
+     * @param colors color of each vertex of the graph
+     * @return std::vector<int> color of each vertex of the original graph
+     */
+    [[nodiscard]] std::vector<int> original_colors(const std::vector<int> &colors) const;
+
+    /**
+     * @brief Return the row of the vertex in the packed adjacency matrix
+     *
+     * @param vertex the vertex
+     * @return const uint64_t* adjacency_row_words words, nullptr if the matrix is not
+     * stored
+     */
+    [[nodiscard]] const uint64_t *adjacency_row(const int vertex) const;
+
+    /**
+     * @brief Return the degree of the vertex
+     *
+     * @param vertex the vertex
+     * @return int its degree
+     */
+    [[nodiscard]] int degree(const int vertex) const;
+
+    /**
+     * @brief Return the position of the edge (vertex1, vertex2) in the CSR,
+     * neighbors_list[position] == vertex2, used to index data on the edges without
+     * quadratic memory
+     *
+     * Binary search in the neighbors sorted by vertex number, linear search if the
+     * neighbors are sorted by weight and the adjacency matrix is stored
+     *
+     * @param vertex1 first vertex
+     * @param vertex2 second vertex
+     * @return int position in neighbors_list, -1 if the vertices are not neighbors
+     */
+    [[nodiscard]] int edge_position(const int vertex1, const int vertex2) const;
+
+    /**
+     * @brief Return whether the packed adjacency matrix is not stored
+     *
+     * @return true adjacency tests use the CSR
+     * @return false adjacency tests use the packed adjacency matrix
+     */
+    [[nodiscard]] bool is_sparse() const;
+
+    /**
+     * @brief Return the memory used by the graph in bytes
+     *
+     * @return std::size_t size of the binary instance and of the neighbors sorted by
+     * vertex number
+     */
+    [[nodiscard]] std::size_t memory_size() const;
+
+    /**
+     * @brief Return whether there is an edge between the vertices
+     *
+     * @param vertex1 first vertex
+     * @param vertex2 second vertex
+     * @return true the vertices are neighbors
+     * @return false the vertices are not neighbors
+     */
+    [[nodiscard]] bool are_neighbors(const int vertex1, const int vertex2) const;
 };
@@ -0,0 +1,274 @@
+#include "GraphCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @brief Magic number of the binary instances*/
+constexpr char graph_cache_magic[8] = {'G', 'C', 'W', 'V', 'C', 'P', 'B', '\0'};
+/** @brief Current version of the binary instances*/
+constexpr uint32_t graph_cache_version = 2;
+/** @brief Alignment of the block and of each section*/
+constexpr uint64_t graph_cache_alignment = 64;
+/** @brief Above this size, the packed adjacency matrix is not stored in auto mode*/
+constexpr uint64_t max_adjacency_bytes = 64 * 1024 * 1024;
+/** @brief Under this density, the graph is sparse in auto mode*/
+constexpr double sparse_density_threshold = 0.01;
+
+/**
+ * @brief Round the position up to the next multiple of the alignment
+ *
+ * @param position position in bytes
+ * @return uint64_t aligned position
+ */
+static uint64_t align_position(const uint64_t position) {
+    return (position + graph_cache_alignment - 1) / graph_cache_alignment *
+           graph_cache_alignment;
+}
+
+GraphStorage::GraphStorage(char *data, const std::size_t size, const bool mapped)
+    : _data(data), _size(size), _mapped(mapped) {
+}
+
+GraphStorage::~GraphStorage() {
+    if (_mapped) {
+        munmap(_data, _size);
+    } else {
+        std::free(_data);
+    }
+}
+
+std::unique_ptr<GraphStorage>
+GraphStorage::build(const int nb_vertices,
+                    const std::vector<std::pair<int, int>> &edges_list,
+                    const std::vector<int> &weights,
+                    const GraphSourceStamp &stamp,
+                    uint32_t flags,
+                    const std::string &graph_mode,
+                    const Reduction &reduction) {
+    const auto n = static_cast<std::size_t>(nb_vertices);
+
+    // CSR with possible duplicates, then each row is sorted and made unique
+    std::vector<int> offsets(n + 1, 0);
+    for (const auto &[v1, v2] : edges_list) {
+        if (v1 != v2) {
+            ++offsets[static_cast<std::size_t>(v1) + 1];
+            ++offsets[static_cast<std::size_t>(v2) + 1];
+        }
+    }
+    for (std::size_t vertex = 0; vertex < n; ++vertex) {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+    std::vector<int> neighbors(static_cast<std::size_t>(offsets[n]));
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (const auto &[v1, v2] : edges_list) {
+        if (v1 != v2) {
+            neighbors[static_cast<std::size_t>(next[static_cast<std::size_t>(v1)]++)] =
+                v2;
+            neighbors[static_cast<std::size_t>(next[static_cast<std::size_t>(v2)]++)] =
+                v1;
+        }
+    }
+    int nb_neighbors = 0;
+    int row_start = 0;
+    for (std::size_t vertex = 0; vertex < n; ++vertex) {
+        const auto begin = neighbors.begin() + row_start;
+        const auto end = neighbors.begin() + offsets[vertex + 1];
+        std::sort(begin, end);
+        const auto last = std::unique(begin, end);
+        row_start = offsets[vertex + 1];
+        offsets[vertex + 1] = nb_neighbors + static_cast<int>(last - begin);
+        std::copy(begin, last, neighbors.begin() + nb_neighbors);
+        nb_neighbors = offsets[vertex + 1];
+    }
+    neighbors.resize(static_cast<std::size_t>(nb_neighbors));
+
+    // heaviest neighbors first, ties keep the increasing vertex number
+    if (flags & graph_cache_neighbors_by_weight) {
+        for (std::size_t vertex = 0; vertex < n; ++vertex) {
+            std::stable_sort(neighbors.begin() + offsets[vertex],
+                             neighbors.begin() + offsets[vertex + 1],
+                             [&weights](const int v1, const int v2) {
+                                 return weights[static_cast<std::size_t>(v1)] >
+                                        weights[static_cast<std::size_t>(v2)];
+                             });
+        }
+    }
+
+    // layout of the block
+    GraphCacheHeader header{};
+    std::memcpy(header.magic, graph_cache_magic, sizeof(graph_cache_magic));
+    header.version = graph_cache_version;
+    if (store_adjacency_matrix(graph_mode, nb_vertices, nb_neighbors / 2)) {
+        flags |= graph_cache_adjacency_matrix;
+    }
+    header.flags = flags;
+    header.nb_vertices = nb_vertices;
+    header.nb_edges = nb_neighbors / 2;
+    header.source_size = stamp.size;
+    header.source_mtime = stamp.mtime;
+    header.offsets_position = align_position(sizeof(GraphCacheHeader));
+    header.neighbors_position =
+        align_position(header.offsets_position + (n + 1) * sizeof(int));
+    header.weights_position = align_position(header.neighbors_position +
+                                             neighbors.size() * sizeof(int));
+    uint64_t end_position = align_position(header.weights_position + n * sizeof(int));
+    header.adjacency_row_words = (n + 63) / 64;
+    const uint64_t adjacency_bytes = n * header.adjacency_row_words * sizeof(uint64_t);
+    if (flags & graph_cache_adjacency_matrix) {
+        header.adjacency_position = end_position;
+        end_position = align_position(end_position + adjacency_bytes);
+    } else {
+        header.adjacency_position = 0;
+    }
+    if (not reduction.original_ids.empty()) {
+        header.original_nb_vertices = reduction.original_nb_vertices;
+        header.nb_removed = static_cast<int32_t>(reduction.removed_vertices.size());
+        const auto nb_removed = reduction.removed_vertices.size();
+        header.original_ids_position = end_position;
+        header.removed_vertices_position =
+            align_position(header.original_ids_position + n * sizeof(int));
+        header.removed_weights_position =
+            align_position(header.removed_vertices_position + nb_removed * sizeof(int));
+        header.removed_offsets_position =
+            align_position(header.removed_weights_position + nb_removed * sizeof(int));
+        header.removed_neighbors_position = align_position(
+            header.removed_offsets_position + (nb_removed + 1) * sizeof(int));
+        end_position = align_position(header.removed_neighbors_position +
+                                      reduction.removed_neighbors.size() * sizeof(int));
+    } else {
+        header.original_nb_vertices = nb_vertices;
+    }
+    header.file_size = end_position;
+
+    auto *data = static_cast<char *>(std::aligned_alloc(graph_cache_alignment,
+                                                        header.file_size));
+    if (not data) {
+        return nullptr;
+    }
+    std::memset(data, 0, header.file_size);
+    std::memcpy(data, &header, sizeof(GraphCacheHeader));
+    std::memcpy(data + header.offsets_position, offsets.data(), (n + 1) * sizeof(int));
+    std::memcpy(data + header.neighbors_position,
+                neighbors.data(),
+                neighbors.size() * sizeof(int));
+    std::memcpy(data + header.weights_position, weights.data(), n * sizeof(int));
+    if (header.adjacency_position != 0) {
+        auto *adjacency = reinterpret_cast<uint64_t *>(data + header.adjacency_position);
+        for (std::size_t vertex = 0; vertex < n; ++vertex) {
+            uint64_t *row = adjacency + vertex * header.adjacency_row_words;
+            for (int i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                const auto neighbor =
+                    static_cast<uint64_t>(neighbors[static_cast<std::size_t>(i)]);
+                row[neighbor / 64] |= uint64_t{1} << (neighbor % 64);
+            }
+        }
+    }
+    if (header.original_ids_position != 0) {
+        const auto copy_section = [data](const uint64_t position,
+                                         const std::vector<int> &section) {
+            std::memcpy(data + position, section.data(), section.size() * sizeof(int));
+        };
+        copy_section(header.original_ids_position, reduction.original_ids);
+        copy_section(header.removed_vertices_position, reduction.removed_vertices);
+        copy_section(header.removed_weights_position, reduction.removed_weights);
+        copy_section(header.removed_offsets_position, reduction.removed_offsets);
+        copy_section(header.removed_neighbors_position, reduction.removed_neighbors);
+    }
+    return std::unique_ptr<GraphStorage>(new GraphStorage(data, header.file_size, false));
+}
+
+std::unique_ptr<GraphStorage> GraphStorage::map(const std::string &file_name,
+                                                const GraphSourceStamp &stamp,
+                                                uint32_t flags,
+                                                const std::string &graph_mode) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 or
+        static_cast<std::size_t>(file_stat.st_size) < sizeof(GraphCacheHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(file_stat.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    std::unique_ptr<GraphStorage> storage(
+        new GraphStorage(static_cast<char *>(data), size, true));
+
+    // check the cache is complete, up to date and built with the same options
+    const GraphCacheHeader &header = storage->header();
+    if (store_adjacency_matrix(graph_mode, header.nb_vertices, header.nb_edges)) {
+        flags |= graph_cache_adjacency_matrix;
+    }
+    if (std::memcmp(header.magic, graph_cache_magic, sizeof(graph_cache_magic)) != 0 or
+        header.version != graph_cache_version or header.flags != flags or
+        header.file_size != size or
+        header.source_size != stamp.size or header.source_mtime != stamp.mtime) {
+        return nullptr;
+    }
+    return storage;
+}
+
+bool GraphStorage::write(const std::string &file_name) const {
+    const std::string tmp_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+    std::FILE *file = std::fopen(tmp_name.c_str(), "wb");
+    if (not file) {
+        return false;
+    }
+    const bool written = std::fwrite(_data, 1, _size, file) == _size;
+    if (std::fclose(file) != 0 or not written or
+        std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+[[nodiscard]] const GraphCacheHeader &GraphStorage::header() const {
+    return *reinterpret_cast<const GraphCacheHeader *>(_data);
+}
+
+[[nodiscard]] bool GraphStorage::mapped() const {
+    return _mapped;
+}
+
+[[nodiscard]] bool store_adjacency_matrix(const std::string &graph_mode,
+                                          const int nb_vertices,
+                                          const int nb_edges) {
+    if (graph_mode == "dense") {
+        return true;
+    }
+    if (graph_mode == "sparse" or nb_vertices < 2) {
+        return false;
+    }
+    const auto n = static_cast<uint64_t>(nb_vertices);
+    const uint64_t adjacency_bytes = n * ((n + 63) / 64) * sizeof(uint64_t);
+    const double density =
+        2.0 * nb_edges / (static_cast<double>(n) * static_cast<double>(n - 1));
+    return adjacency_bytes <= max_adjacency_bytes and density >= sparse_density_threshold;
+}
+
+[[nodiscard]] GraphSourceStamp get_source_stamp(const std::vector<std::string> &file_names) {
+    GraphSourceStamp stamp;
+    for (const auto &file_name : file_names) {
+        struct stat file_stat;
+        if (stat(file_name.c_str(), &file_stat) != 0) {
+            return GraphSourceStamp{};
+        }
+        stamp.size += file_stat.st_size;
+        stamp.mtime = std::max<int64_t>(stamp.mtime, file_stat.st_mtime);
+    }
+    return stamp;
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Reduction.hpp"
+
+/**
+ * @brief Header of a binary instance
+ *
+ * A binary instance is a single block of memory laid out as follow (each section starts
+ * on a 64 bytes boundary) :
+ * - the header
+ * - CSR offsets : nb_vertices + 1 int, neighbors of v are in [offsets[v], offsets[v+1])
+ * - CSR neighbors : 2 * nb_edges int, sorted by increasing vertex number (or by
+ * decreasing weight then increasing vertex number with graph_cache_neighbors_by_weight)
+ * - weights : nb_vertices int
+ * - (optional, dense graphs) packed adjacency matrix : nb_vertices rows of
+ * adjacency_row_words uint64_t, bit v of row u is set if (u, v) is an edge
+ *
+ * The same block is used when the instance is loaded from the .col file (built in memory
+ * then written on disk) or from the cache (memory-mapped read-only).
+ */
+struct GraphCacheHeader {
+    /** @brief Identify the file format*/
+    char magic[8];
+    /** @brief Version of the format, the cache is rebuilt if it differs*/
+    uint32_t version;
+    /** @brief Options of the binary instance (graph_cache_neighbors_by_weight,
+     * graph_cache_adjacency_matrix)*/
+    uint32_t flags;
+    /** @brief Number of vertices in the graph*/
+    int32_t nb_vertices;
+    /** @brief Number of edges in the graph (without duplicates)*/
+    int32_t nb_edges;
+    /** @brief Sum of the sizes of the source files (.col and .col.w)*/
+    int64_t source_size;
+    /** @brief Last modification time of the source files*/
+    int64_t source_mtime;
+    /** @brief Position in bytes of the CSR offsets*/
+    uint64_t offsets_position;
+    /** @brief Position in bytes of the CSR neighbors*/
+    uint64_t neighbors_position;
+    /** @brief Position in bytes of the weights*/
+    uint64_t weights_position;
+    /** @brief Position in bytes of the packed adjacency matrix (0 if not stored)*/
+    uint64_t adjacency_position;
+    /** @brief Number of 64 bits words per row of the adjacency matrix*/
+    uint64_t adjacency_row_words;
+    /** @brief Total size in bytes of the block*/
+    uint64_t file_size;
+    /** @brief Number of vertices of the original graph (before the reduction)*/
+    int32_t original_nb_vertices;
+    /** @brief Number of vertices removed by the reduction*/
+    int32_t nb_removed;
+    /** @brief Position in bytes of the original ids of the vertices (0 if not reduced)*/
+    uint64_t original_ids_position;
+    /** @brief Position in bytes of the removed vertices*/
+    uint64_t removed_vertices_position;
+    /** @brief Position in bytes of the weights of the removed vertices*/
+    uint64_t removed_weights_position;
+    /** @brief Position in bytes of the CSR offsets of the removed vertices*/
+    uint64_t removed_offsets_position;
+    /** @brief Position in bytes of the CSR neighbors of the removed vertices*/
+    uint64_t removed_neighbors_position;
+};
+
+/** @brief Flag set when the neighbors are sorted by decreasing weight*/
+constexpr uint32_t graph_cache_neighbors_by_weight = 1;
+/** @brief Flag set when the packed adjacency matrix is stored*/
+constexpr uint32_t graph_cache_adjacency_matrix = 2;
+/** @brief Flag set when the instance has been reduced from the original graph*/
+constexpr uint32_t graph_cache_reduced = 4;
+/** @brief Flag set when the vertices have been relabelled (reverse Cuthill-McKee)*/
+constexpr uint32_t graph_cache_relabelled = 8;
+
+/**
+ * @brief Stamp of the source files of an instance, used to detect outdated caches
+ *
+ */
+struct GraphSourceStamp {
+    /** @brief Sum of the sizes of the source files*/
+    int64_t size{0};
+    /** @brief Last modification time of the source files*/
+    int64_t mtime{0};
+};
+
+/**
+ * @brief Memory holding a binary instance, either a memory-mapped cache file or a heap
+ * buffer built from the .col file
+ *
+ */
+class GraphStorage {
+    /** @brief Beginning of the block (64 bytes aligned)*/
+    char *_data{nullptr};
+    /** @brief Size of the block in bytes*/
+    std::size_t _size{0};
+    /** @brief True if the block is a memory-mapped file*/
+    bool _mapped{false};
+
+    GraphStorage(char *data, const std::size_t size, const bool mapped);
+
+  public:
+    GraphStorage(const GraphStorage &other) = delete;
+    GraphStorage &operator=(const GraphStorage &other) = delete;
+
+    /**
+     * @brief Release the memory (unmap the file or free the buffer)
+     *
+     */
+    ~GraphStorage();
+
+    /**
+     * @brief Build the binary instance in memory
+     *
+     * Duplicated edges and self loops are removed, the packed adjacency matrix is
+     * stored according to the graph mode (see store_adjacency_matrix)
+     *
+     * @param nb_vertices number of vertices
+     * @param edges_list list of the edges (0 indexed)
+     * @param weights weight of each vertex
+     * @param stamp stamp of the source files
+     * @param flags options of the binary instance (graph_cache_neighbors_by_weight,
+     * graph_cache_reduced, graph_cache_relabelled)
+     * @param graph_mode storage of the adjacency (auto, dense, sparse)
+     * @param reduction link with the original graph (empty original_ids if the instance
+     * is neither reduced nor relabelled)
+     * @return std::unique_ptr<GraphStorage> the binary instance
+     */
+    static std::unique_ptr<GraphStorage>
+    build(const int nb_vertices,
+          const std::vector<std::pair<int, int>> &edges_list,
+          const std::vector<int> &weights,
+          const GraphSourceStamp &stamp,
+          uint32_t flags,
+          const std::string &graph_mode,
+          const Reduction &reduction);
+
+    /**
+     * @brief Memory-map a binary instance read-only
+     *
+     * @param file_name the cache file
+     * @param stamp stamp of the source files, the cache must match it
+     * @param flags options of the binary instance (graph_cache_neighbors_by_weight,
+     * graph_cache_reduced, graph_cache_relabelled)
+     * @param graph_mode storage of the adjacency (auto, dense, sparse)
+     * @return std::unique_ptr<GraphStorage> the binary instance, nullptr if the file is
+     * missing, invalid, outdated or built with other options
+     */
+    static std::unique_ptr<GraphStorage> map(const std::string &file_name,
+                                             const GraphSourceStamp &stamp,
+                                             uint32_t flags,
+                                             const std::string &graph_mode);
+
+    /**
+     * @brief Write the binary instance to the file
+     *
+     * The file is written under a temporary name then renamed so concurrent jobs never
+     * map a partially written file
+     *
+     * @param file_name the cache file
+     * @return true the file has been written
+     * @return false the file couldn't be written
+     */
+    bool write(const std::string &file_name) const;
+
+    /**
+     * @brief Return the header of the binary instance
+     *
+     * @return const GraphCacheHeader& the header
+     */
+    [[nodiscard]] const GraphCacheHeader &header() const;
+
+    /**
+     * @brief Return a pointer to a section of the block
+     *
+     * @tparam T type of the elements of the section
+     * @param position position in bytes of the section
+     * @return const T* first element of the section
+     */
+    template <typename T> [[nodiscard]] const T *section(const uint64_t position) const {
+        return reinterpret_cast<const T *>(_data + position);
+    }
+
+    /**
+     * @brief Return whether the block is a memory-mapped file
+     *
+     * @return true the block is mapped from the cache
+     * @return false the block has been built from the .col file
+     */
+    [[nodiscard]] bool mapped() const;
+};
+
+/**
+ * @brief Return whether the packed adjacency matrix must be stored
+ *
+ * In auto mode, the matrix is stored if the graph is dense enough and the matrix is not
+ * too big, otherwise the adjacency goes through the CSR only (no quadratic memory)
+ *
+ * @param graph_mode storage of the adjacency (auto, dense, sparse)
+ * @param nb_vertices number of vertices
+ * @param nb_edges number of edges (without duplicates)
+ * @return true the matrix must be stored
+ * @return false only the CSR is stored
+ */
+[[nodiscard]] bool store_adjacency_matrix(const std::string &graph_mode,
+                                          const int nb_vertices,
+                                          const int nb_edges);
+
+/**
+ * @brief Get the stamp of the source files of an instance
+ *
+ * @param file_names the source files
+ * @return GraphSourceStamp the stamp (size and mtime to 0 if a file is missing)
+ */
+[[nodiscard]] GraphSourceStamp get_source_stamp(const std::vector<std::string> &file_names);
@@ -0,0 +1,600 @@
+#include "MoveCache.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <random>
+
+#include "../utils/random_generator.hpp"
+#include "Graph.hpp"
+
+namespace {
+/** @brief Delta of no move*/
+constexpr int no_delta = std::numeric_limits<int>::max();
+} // namespace
+
+MoveCache::MoveCache(Solution &solution,
+                     const int penalty_coeff,
+                     const bool tabu_colors,
+                     const int max_nb_colors)
+    : _solution(solution),
+      _penalty_coeff(penalty_coeff),
+      _tabu_colors(tabu_colors),
+      _max_nb_colors(max_nb_colors),
+      _tabu_stride(
+          tabu_colors ? static_cast<std::size_t>(std::max(solution.nb_colors(), 1)) : 1),
+      _tabu(static_cast<std::size_t>(Graph::g->nb_vertices) * _tabu_stride, 0),
+      _moves(static_cast<std::size_t>(Graph::g->nb_vertices),
+             VertexMoves{
+                 no_delta, 0, no_delta, 0, 0, 0, std::numeric_limits<long>::max()}),
+      _dirty_vertices(Graph::g->nb_vertices),
+      _conflicting_vertices(Graph::g->nb_vertices),
+      _heaviest_vertices(static_cast<std::size_t>(Graph::g->nb_vertices)) {
+    while (_nb_leaves < static_cast<std::size_t>(Graph::g->nb_vertices)) {
+        _nb_leaves *= 2;
+    }
+    _tree.assign(2 * _nb_leaves, TreeNode{no_delta, 0, no_delta, 0});
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        _heaviest_vertices[static_cast<std::size_t>(vertex)] = vertex;
+        if (_solution.has_conflicts(vertex)) {
+            _conflicting_vertices.insert(vertex);
+        }
+    }
+    std::stable_sort(_heaviest_vertices.begin(),
+                     _heaviest_vertices.end(),
+                     [](const int vertex1, const int vertex2) {
+                         return Graph::g->weights[vertex1] > Graph::g->weights[vertex2];
+                     });
+}
+
+template <typename Problem, typename Function>
+void MoveCache::for_each_move(const int vertex, Function function) {
+    const int vertex_color = _solution.color(vertex);
+    const auto nb_colors = static_cast<std::size_t>(_solution.nb_colors());
+    if (_deltas.size() < nb_colors) {
+        _deltas.resize(nb_colors);
+        _conflicts.resize(nb_colors);
+    }
+    _solution.delta_moves<Problem>(
+        vertex, _penalty_coeff, _deltas.data(), _conflicts.data());
+    for (const int color : _solution.non_empty_colors()) {
+        if (color == vertex_color) {
+            continue;
+        }
+        const int nb_conflicts = _conflicts[static_cast<std::size_t>(color)];
+        if (_penalty_coeff == 0 and nb_conflicts != 0) {
+            continue;
+        }
+        const int delta = _deltas[static_cast<std::size_t>(color)];
+        if (function(color, delta, nb_conflicts == 0)) {
+            return;
+        }
+    }
+    if (static_cast<int>(_solution.non_empty_colors().size()) < _max_nb_colors) {
+        const int delta = _solution.delta_wvcp_score<Problem>(vertex, -1) +
+                          _penalty_coeff * _solution.delta_conflicts(vertex, -1);
+        function(-1, delta, true);
+    }
+}
+
+[[nodiscard]] bool
+MoveCache::is_tabu(const int vertex, const int color, const long turn) const {
+    // a new color is never tabu
+    if (_tabu_colors and color == -1) {
+        return false;
+    }
+    const std::size_t index = static_cast<std::size_t>(vertex) * _tabu_stride +
+                              (_tabu_colors ? static_cast<std::size_t>(color) : 0);
+    return _tabu[index] > turn;
+}
+
+template <typename Problem>
+[[nodiscard]] MoveCache::ColorState MoveCache::color_state(const int color) const {
+    return ColorState{_solution.colors_vertices(color).size() == 1,
+                      _solution.max_weight<Problem>(color),
+                      _solution.second_max_weight<Problem>(color)};
+}
+
+template <typename Problem>
+void MoveCache::update_moves(const int vertex, const long turn, const bool update_tree) {
+    VertexMoves &moves = _moves[static_cast<std::size_t>(vertex)];
+    _nb_improving -= moves.nb_improving;
+    _nb_neutral -= moves.nb_neutral;
+    _nb_moves -= moves.nb_moves;
+    moves = VertexMoves{no_delta, 0, no_delta, 0, 0, 0, std::numeric_limits<long>::max()};
+
+    const std::size_t vertex_index =
+        static_cast<std::size_t>(vertex) * _tabu_stride;
+    const bool vertex_tabu = not _tabu_colors and _tabu[vertex_index] > turn;
+    if (vertex_tabu) {
+        moves.valid_until = _tabu[vertex_index] - 1;
+    }
+    const auto count_move = [&](const int color, const int delta, const bool legal) {
+        ++moves.nb_moves;
+        if (delta < 0) {
+            ++moves.nb_improving;
+        } else if (delta == 0) {
+            ++moves.nb_neutral;
+        }
+        if (legal) {
+            moves.best_legal_delta = std::min(moves.best_legal_delta, delta);
+        }
+        if (vertex_tabu) {
+            return false;
+        }
+        if (is_tabu(vertex, color, turn)) {
+            moves.valid_until =
+                std::min(moves.valid_until,
+                         _tabu[vertex_index + static_cast<std::size_t>(color)] - 1);
+            return false;
+        }
+        if (delta < moves.best_delta) {
+            moves.best_delta = delta;
+            moves.nb_best = 0;
+        }
+        if (delta == moves.best_delta) {
+            ++moves.nb_best;
+        }
+        return false;
+    };
+    for_each_move<Problem>(vertex, count_move);
+    _nb_improving += moves.nb_improving;
+    _nb_neutral += moves.nb_neutral;
+    _nb_moves += moves.nb_moves;
+    if (moves.valid_until != std::numeric_limits<long>::max()) {
+        _expirations.emplace(moves.valid_until + 1, vertex);
+    }
+
+    std::size_t node = _nb_leaves + static_cast<std::size_t>(vertex);
+    _tree[node] =
+        TreeNode{moves.best_delta, moves.nb_best, moves.best_legal_delta, moves.nb_moves};
+    if (not update_tree) {
+        return;
+    }
+    for (node /= 2; node > 0; node /= 2) {
+        const TreeNode &left = _tree[2 * node];
+        const TreeNode &right = _tree[2 * node + 1];
+        const int best_delta = std::min(left.best_delta, right.best_delta);
+        _tree[node] = TreeNode{best_delta,
+                               (left.best_delta == best_delta ? left.nb_best : 0) +
+                                   (right.best_delta == best_delta ? right.nb_best : 0),
+                               std::min(left.best_legal_delta, right.best_legal_delta),
+                               left.nb_moves + right.nb_moves};
+    }
+}
+
+void MoveCache::build_tree() {
+    for (std::size_t node = _nb_leaves - 1; node > 0; --node) {
+        const TreeNode &left = _tree[2 * node];
+        const TreeNode &right = _tree[2 * node + 1];
+        const int best_delta = std::min(left.best_delta, right.best_delta);
+        _tree[node] = TreeNode{best_delta,
+                               (left.best_delta == best_delta ? left.nb_best : 0) +
+                                   (right.best_delta == best_delta ? right.nb_best : 0),
+                               std::min(left.best_legal_delta, right.best_legal_delta),
+                               left.nb_moves + right.nb_moves};
+    }
+}
+
+template <typename Problem> void MoveCache::refresh(const long turn) {
+    _turn = turn;
+    while (not _expirations.empty() and _expirations.top().first <= turn) {
+        const int vertex = _expirations.top().second;
+        _expirations.pop();
+        if (_moves[static_cast<std::size_t>(vertex)].valid_until < turn) {
+            _dirty_vertices.insert(vertex);
+        }
+    }
+    if (not _all_dirty) {
+        // after a color created or emptied, the tree is built once from the leaves
+        for (const int vertex : _dirty_vertices) {
+            update_moves<Problem>(vertex, turn, not _rebuild_tree);
+        }
+        _dirty_vertices.clear();
+        if (_rebuild_tree) {
+            build_tree();
+            _rebuild_tree = false;
+        }
+        return;
+    }
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        update_moves<Problem>(vertex, turn, false);
+    }
+    build_tree();
+    _dirty_vertices.clear();
+    _all_dirty = false;
+    _rebuild_tree = false;
+}
+
+template <typename Problem>
+void MoveCache::color_changed(const int color, const ColorState &before) {
+    const ColorState after = color_state<Problem>(color);
+    // the moves of the vertices of the color
+    if (after.single != before.single or after.max_weight != before.max_weight or
+        after.second_max_weight != before.second_max_weight) {
+        for (const int vertex : _solution.colors_vertices(color)) {
+            _dirty_vertices.insert(vertex);
+        }
+    }
+    // the moves to the color of the vertices heavier than its heaviest vertex
+    if (after.max_weight != before.max_weight) {
+        const int min_weight = std::min(after.max_weight, before.max_weight);
+        for (const int vertex : _heaviest_vertices) {
+            if (Graph::g->weights[vertex] <= min_weight) {
+                break;
+            }
+            _dirty_vertices.insert(vertex);
+        }
+    }
+}
+
+template <typename Problem>
+void MoveCache::column_changed(const int color, const int max_weight, const bool added) {
+    const int sign = added ? 1 : -1;
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        if (_dirty_vertices.contains(vertex)) {
+            continue;
+        }
+        VertexMoves &moves = _moves[static_cast<std::size_t>(vertex)];
+        // the vertices not dirty are not neighbors of the moved vertex, the only vertex
+        // of the color, so the move has no conflict
+        const int weight = Problem::weighted ? Graph::g->weights[vertex] : 1;
+        const int delta =
+            _solution.delta_wvcp_score_old_color<Problem>(vertex) -
+            _penalty_coeff * _solution.conflicts_colors(_solution.color(vertex), vertex) +
+            std::max(weight - max_weight, 0);
+        const bool tabu = is_tabu(vertex, color, _turn);
+        moves.nb_moves += sign;
+        _nb_moves += sign;
+        if (delta < 0) {
+            moves.nb_improving += sign;
+            _nb_improving += sign;
+        } else if (delta == 0) {
+            moves.nb_neutral += sign;
+            _nb_neutral += sign;
+        }
+        if (added) {
+            moves.best_legal_delta = std::min(moves.best_legal_delta, delta);
+            if (tabu) {
+                const std::size_t index =
+                    static_cast<std::size_t>(vertex) * _tabu_stride +
+                    (_tabu_colors ? static_cast<std::size_t>(color) : 0);
+                if (_tabu[index] - 1 < moves.valid_until) {
+                    moves.valid_until = _tabu[index] - 1;
+                    _expirations.emplace(moves.valid_until + 1, vertex);
+                }
+            } else {
+                if (delta < moves.best_delta) {
+                    moves.best_delta = delta;
+                    moves.nb_best = 0;
+                }
+                if (delta == moves.best_delta) {
+                    ++moves.nb_best;
+                }
+            }
+        } else if (delta == moves.best_legal_delta or
+                   (not tabu and delta == moves.best_delta and moves.nb_best == 1)) {
+            // the lowest deltas may have changed
+            _dirty_vertices.insert(vertex);
+            continue;
+        } else if (not tabu and delta == moves.best_delta) {
+            --moves.nb_best;
+        }
+        _tree[_nb_leaves + static_cast<std::size_t>(vertex)] = TreeNode{
+            moves.best_delta, moves.nb_best, moves.best_legal_delta, moves.nb_moves};
+    }
+    _rebuild_tree = true;
+}
+
+template <typename Problem> int MoveCache::move(const int vertex, const int color) {
+    const int old_color = _solution.color(vertex);
+    const std::size_t nb_colors = _solution.non_empty_colors().size();
+    const ColorState old_color_before = color_state<Problem>(old_color);
+    const ColorState color_before =
+        color == -1 ? ColorState{} : color_state<Problem>(color);
+    _solution.delete_from_color<Problem>(vertex);
+    const int new_color = _solution.add_to_color<Problem>(vertex, color);
+
+    _dirty_vertices.insert(vertex);
+    if (_solution.has_conflicts(vertex)) {
+        _conflicting_vertices.insert(vertex);
+    } else {
+        _conflicting_vertices.erase(vertex);
+    }
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        _dirty_vertices.insert(neighbor);
+        if (_solution.has_conflicts(neighbor)) {
+            _conflicting_vertices.insert(neighbor);
+        } else {
+            _conflicting_vertices.erase(neighbor);
+        }
+    }
+    // a color created or emptied adds or removes a move of the other vertices
+    const bool emptied = old_color_before.single;
+    const bool created = color == -1;
+    if (not emptied) {
+        color_changed<Problem>(old_color, old_color_before);
+    }
+    if (not created) {
+        color_changed<Problem>(new_color, color_before);
+    }
+
+    if (_tabu_colors and static_cast<std::size_t>(new_color) >= _tabu_stride) {
+        const std::size_t stride =
+            std::max(2 * _tabu_stride, static_cast<std::size_t>(new_color) + 1);
+        const auto nb_vertices = static_cast<std::size_t>(Graph::g->nb_vertices);
+        std::vector<long> tabu(nb_vertices * stride, 0);
+        for (std::size_t v = 0; v < nb_vertices; ++v) {
+            std::copy_n(_tabu.begin() + static_cast<long>(v * _tabu_stride),
+                        _tabu_stride,
+                        tabu.begin() + static_cast<long>(v * stride));
+        }
+        _tabu = std::move(tabu);
+        _tabu_stride = stride;
+    }
+
+    if (_all_dirty or (emptied and created and new_color == old_color)) {
+        return old_color;
+    }
+    if (emptied) {
+        column_changed<Problem>(old_color, old_color_before.max_weight, false);
+    }
+    if (created) {
+        column_changed<Problem>(
+            new_color, _solution.max_weight<Problem>(new_color), true);
+    }
+    // the move to a new color is possible only with less colors than the maximum
+    const auto max_nb_colors = static_cast<std::size_t>(std::max(_max_nb_colors, 0));
+    const bool new_color_before = nb_colors < max_nb_colors;
+    const bool new_color_after = _solution.non_empty_colors().size() < max_nb_colors;
+    if (new_color_before != new_color_after) {
+        column_changed<Problem>(-1, 0, new_color_after);
+    }
+    return old_color;
+}
+
+void MoveCache::set_tabu(const int vertex, const int color, const long turn) {
+    const std::size_t index = static_cast<std::size_t>(vertex) * _tabu_stride +
+                              (_tabu_colors ? static_cast<std::size_t>(color) : 0);
+    _tabu[index] = turn;
+    _dirty_vertices.insert(vertex);
+}
+
+[[nodiscard]] std::pair<int, int> MoveCache::best_moves(const std::size_t node,
+                                                        const std::size_t begin,
+                                                        const std::size_t end,
+                                                        const std::size_t first) const {
+    if (end <= first) {
+        return {no_delta, 0};
+    }
+    if (begin >= first) {
+        return {_tree[node].best_delta, _tree[node].nb_best};
+    }
+    const std::size_t middle = (begin + end) / 2;
+    const auto left = best_moves(2 * node, begin, middle, first);
+    const auto right = best_moves(2 * node + 1, middle, end, first);
+    const int best_delta = std::min(left.first, right.first);
+    return {best_delta,
+            (left.first == best_delta ? left.second : 0) +
+                (right.first == best_delta ? right.second : 0)};
+}
+
+[[nodiscard]] int MoveCache::find_best(const std::size_t node,
+                                       const std::size_t begin,
+                                       const std::size_t end,
+                                       const std::size_t first,
+                                       const int best_delta,
+                                       int &index) const {
+    if (end <= first) {
+        return -1;
+    }
+    if (begin >= first) {
+        // the lowest delta of the range is best_delta
+        if (_tree[node].best_delta != best_delta) {
+            return -1;
+        }
+        if (index >= _tree[node].nb_best) {
+            index -= _tree[node].nb_best;
+            return -1;
+        }
+        if (node >= _nb_leaves) {
+            return static_cast<int>(begin);
+        }
+    }
+    const std::size_t middle = (begin + end) / 2;
+    const int vertex = find_best(2 * node, begin, middle, first, best_delta, index);
+    if (vertex != -1) {
+        return vertex;
+    }
+    return find_best(2 * node + 1, middle, end, first, best_delta, index);
+}
+
+[[nodiscard]] int MoveCache::last_legal(const std::size_t node,
+                                        const std::size_t begin,
+                                        const std::size_t end,
+                                        const int bound) const {
+    if (_tree[node].best_legal_delta >= bound) {
+        return -1;
+    }
+    if (node >= _nb_leaves) {
+        return static_cast<int>(begin);
+    }
+    const std::size_t middle = (begin + end) / 2;
+    const int vertex = last_legal(2 * node + 1, middle, end, bound);
+    if (vertex != -1) {
+        return vertex;
+    }
+    return last_legal(2 * node, begin, middle, bound);
+}
+
+template <typename Problem>
+[[nodiscard]] Coloration MoveCache::nth_best_move(const int vertex,
+                                                  const int best_delta,
+                                                  const long turn,
+                                                  int index) {
+    Coloration move{vertex, -1};
+    for_each_move<Problem>(vertex, [&](const int color, const int delta, const bool) {
+        if (delta != best_delta or is_tabu(vertex, color, turn)) {
+            return false;
+        }
+        if (index == 0) {
+            move.color = color;
+            return true;
+        }
+        --index;
+        return false;
+    });
+    return move;
+}
+
+template <typename Problem>
+[[nodiscard]] bool
+MoveCache::best_move(const long turn, const int best_score, Coloration &move) {
+    refresh<Problem>(turn);
+    const int penalty = _solution.penalty();
+    const long base_score = _solution.score_wvcp() + _penalty_coeff * penalty;
+    const int bound = static_cast<int>(
+        std::clamp(best_score - base_score,
+                   static_cast<long>(std::numeric_limits<int>::min()),
+                   static_cast<long>(std::numeric_limits<int>::max())));
+
+    // last vertex with a move reaching a legal solution better than the best one
+    int aspiration_vertex = -1;
+    if (penalty == 0) {
+        aspiration_vertex = last_legal(1, 0, _nb_leaves, bound);
+    } else {
+        // only a vertex in all the conflicts can remove them
+        for (const int vertex : _conflicting_vertices) {
+            if (_solution.conflicts_colors(_solution.color(vertex), vertex) == penalty and
+                _moves[static_cast<std::size_t>(vertex)].best_legal_delta < bound) {
+                aspiration_vertex = std::max(aspiration_vertex, vertex);
+            }
+        }
+    }
+
+    // the last of these moves is taken, then the best non tabu moves after it
+    int best_delta = no_delta;
+    std::vector<Coloration> first_moves;
+    std::size_t first = 0;
+    if (aspiration_vertex != -1) {
+        int aspiration_color = -1;
+        for_each_move<Problem>(aspiration_vertex,
+                               [&](const int color, const int delta, const bool legal) {
+                                   if (legal and delta < bound) {
+                                       aspiration_color = color;
+                                       best_delta = delta;
+                                   }
+                                   return false;
+                               });
+        first_moves.push_back(Coloration{aspiration_vertex, aspiration_color});
+        bool after = false;
+        for_each_move<Problem>(
+            aspiration_vertex, [&](const int color, const int delta, const bool) {
+                if (after and not is_tabu(aspiration_vertex, color, turn)) {
+                    if (delta < best_delta) {
+                        best_delta = delta;
+                        first_moves.clear();
+                    }
+                    if (delta == best_delta) {
+                        first_moves.push_back(Coloration{aspiration_vertex, color});
+                    }
+                }
+                after = after or color == aspiration_color;
+                return false;
+            });
+        first = static_cast<std::size_t>(aspiration_vertex) + 1;
+    }
+    const auto [range_delta, range_nb_best] = best_moves(1, 0, _nb_leaves, first);
+    if (range_nb_best > 0 and range_delta < best_delta) {
+        best_delta = range_delta;
+        first_moves.clear();
+    }
+    const int nb_first_moves = static_cast<int>(first_moves.size());
+    const int nb_best =
+        nb_first_moves + (range_delta == best_delta ? range_nb_best : 0);
+    if (nb_best == 0) {
+        return false;
+    }
+
+    std::uniform_int_distribution<> distribution(0, nb_best - 1);
+    int index = distribution(rd::generator);
+    if (index < nb_first_moves) {
+        move = first_moves[static_cast<std::size_t>(index)];
+        return true;
+    }
+    index -= nb_first_moves;
+    const int vertex = find_best(1, 0, _nb_leaves, first, best_delta, index);
+    assert(vertex != -1);
+    move = nth_best_move<Problem>(vertex, best_delta, turn, index);
+    return true;
+}
+
+template <typename Problem> [[nodiscard]] int MoveCache::best_delta(const long turn) {
+    refresh<Problem>(turn);
+    return _tree[1].best_delta;
+}
+
+template <typename Problem>
+[[nodiscard]] bool MoveCache::random_move(const long turn, Coloration &move) {
+    refresh<Problem>(turn);
+    if (_nb_moves == 0) {
+        return false;
+    }
+    std::uniform_int_distribution<> distribution(0, static_cast<int>(_nb_moves) - 1);
+    int index = distribution(rd::generator);
+    std::size_t node = 1;
+    while (node < _nb_leaves) {
+        if (index < _tree[2 * node].nb_moves) {
+            node = 2 * node;
+        } else {
+            index -= _tree[2 * node].nb_moves;
+            node = 2 * node + 1;
+        }
+    }
+    const int vertex = static_cast<int>(node - _nb_leaves);
+    move = Coloration{vertex, -1};
+    for_each_move<Problem>(vertex, [&](const int color, const int, const bool) {
+        if (index == 0) {
+            move.color = color;
+            return true;
+        }
+        --index;
+        return false;
+    });
+    return true;
+}
+
+template <typename Problem>
+[[nodiscard]] long MoveCache::nb_improving(const long turn) {
+    refresh<Problem>(turn);
+    return _nb_improving;
+}
+
+template <typename Problem> [[nodiscard]] long MoveCache::nb_neutral(const long turn) {
+    refresh<Problem>(turn);
+    return _nb_neutral;
+}
+
+template <typename Problem> [[nodiscard]] long MoveCache::nb_moves(const long turn) {
+    refresh<Problem>(turn);
+    return _nb_moves;
+}
+
+template bool MoveCache::best_move<ProblemWVCP>(const long turn,
+                                                const int best_score,
+                                                Coloration &move);
+template bool MoveCache::best_move<ProblemGCP>(const long turn,
+                                               const int best_score,
+                                               Coloration &move);
+template int MoveCache::best_delta<ProblemWVCP>(const long turn);
+template int MoveCache::best_delta<ProblemGCP>(const long turn);
+template bool MoveCache::random_move<ProblemWVCP>(const long turn, Coloration &move);
+template bool MoveCache::random_move<ProblemGCP>(const long turn, Coloration &move);
+template int MoveCache::move<ProblemWVCP>(const int vertex, const int color);
+template int MoveCache::move<ProblemGCP>(const int vertex, const int color);
+template long MoveCache::nb_improving<ProblemWVCP>(const long turn);
+template long MoveCache::nb_improving<ProblemGCP>(const long turn);
+template long MoveCache::nb_neutral<ProblemWVCP>(const long turn);
+template long MoveCache::nb_neutral<ProblemGCP>(const long turn);
+template long MoveCache::nb_moves<ProblemWVCP>(const long turn);
+template long MoveCache::nb_moves<ProblemGCP>(const long turn);
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "../utils/sparse_set.hpp"
+#include "Solution.hpp"
+#include "enum_types.hpp"
+
+/**
+ * @brief Moves of the WVCP tabu searches (tabu_weight, AFISA) maintained incrementally
+ * on a solution
+ *
+ * A move colors a vertex with another non empty color or a new color (-1), its delta is
+ * the delta of the score plus the penalty coefficient times the delta of the conflicts.
+ * With a coefficient of 0, only the moves without conflicts are considered (the solution
+ * stays legal)
+ *
+ * The deltas of a vertex only change when the vertex or a neighbor moves, when the
+ * heaviest or second heaviest weights of its color change or when the heaviest weight of
+ * another color changes (for the vertices heavier than it). The cache keeps for each
+ * vertex the lowest delta of its non tabu moves, the lowest delta of its moves without
+ * conflicts and the number of its moves, recomputed only for the vertices marked as dirty
+ * or whose tabu expires. A color created or emptied adds or removes one move of each
+ * vertex, the other vertices are updated without evaluating the other colors and
+ * recomputed only if their lowest delta was the one of the removed move. A segment tree
+ * on the vertices gives the best moves without scanning the other vertices
+ *
+ * The moves are selected as by a scan of the vertices and of the non empty colors (then
+ * the new color) : the best non tabu moves, but a move reaching a legal solution better
+ * than the best one is taken from the last of them in the scan, with the moves after it.
+ * The move is drawn among them with the same draw as rd::choice
+ *
+ */
+class MoveCache {
+  private:
+    /** @brief Moves of a vertex*/
+    struct VertexMoves {
+        /** @brief Lowest delta of the non tabu moves*/
+        int best_delta;
+        /** @brief Number of non tabu moves with the lowest delta*/
+        int nb_best;
+        /** @brief Lowest delta of the moves without conflicts (tabu or not)*/
+        int best_legal_delta;
+        /** @brief Number of moves*/
+        int nb_moves;
+        /** @brief Number of moves with a negative delta*/
+        int nb_improving;
+        /** @brief Number of moves with a null delta*/
+        int nb_neutral;
+        /** @brief Last turn before a tabu move of the vertex expires*/
+        long valid_until;
+    };
+
+    /** @brief Node of the segment tree on the vertices*/
+    struct TreeNode {
+        /** @brief Lowest delta of the non tabu moves*/
+        int best_delta;
+        /** @brief Number of non tabu moves with the lowest delta*/
+        int nb_best;
+        /** @brief Lowest delta of the moves without conflicts*/
+        int best_legal_delta;
+        /** @brief Number of moves*/
+        int nb_moves;
+    };
+
+    /** @brief State of a color the deltas depend on*/
+    struct ColorState {
+        /** @brief True if the color has one vertex*/
+        bool single;
+        /** @brief Heaviest weight*/
+        int max_weight;
+        /** @brief Second heaviest weight*/
+        int second_max_weight;
+    };
+
+    /** @brief The solution searched*/
+    Solution &_solution;
+    /** @brief Coefficient of the conflicts in the deltas, 0 for the legal moves only*/
+    const int _penalty_coeff;
+    /** @brief True if a vertex is tabu for a color, false if it is tabu for all*/
+    const bool _tabu_colors;
+    /** @brief A new color is used only with less non empty colors*/
+    const int _max_nb_colors;
+    /** @brief Number of colors of each vertex in the tabu array*/
+    std::size_t _tabu_stride;
+    /** @brief For each vertex (and color), first turn where the move is not tabu*/
+    std::vector<long> _tabu;
+    /** @brief Moves of each vertex*/
+    std::vector<VertexMoves> _moves;
+    /** @brief Number of leaves of the segment tree (power of 2)*/
+    std::size_t _nb_leaves{1};
+    /** @brief Segment tree, the root is at 1 and the leaves of the vertices at
+     * _nb_leaves*/
+    std::vector<TreeNode> _tree{};
+    /** @brief Vertices whose moves must be recomputed*/
+    SparseSet _dirty_vertices;
+    /** @brief True if the moves of all the vertices must be recomputed*/
+    bool _all_dirty{true};
+    /** @brief True if leaves of vertices not dirty changed since the last refresh*/
+    bool _rebuild_tree{false};
+    /** @brief Turn of the last refresh, the moves of the vertices not dirty are up to
+     * date at this turn*/
+    long _turn{0};
+    /** @brief Turns where the tabu of a vertex expires*/
+    std::priority_queue<std::pair<long, int>,
+                        std::vector<std::pair<long, int>>,
+                        std::greater<std::pair<long, int>>>
+        _expirations{};
+    /** @brief Vertices with conflicts*/
+    SparseSet _conflicting_vertices;
+    /** @brief Vertices by decreasing weight*/
+    std::vector<int> _heaviest_vertices{};
+    /** @brief For each color, delta of the move of a vertex (buffer of for_each_move)*/
+    std::vector<int> _deltas{};
+    /** @brief For each color, conflicts of a vertex (buffer of for_each_move)*/
+    std::vector<int> _conflicts{};
+    /** @brief Number of moves with a negative delta*/
+    long _nb_improving{0};
+    /** @brief Number of moves with a null delta*/
+    long _nb_neutral{0};
+    /** @brief Number of moves*/
+    long _nb_moves{0};
+
+    /**
+     * @brief Call the function on each move of the vertex in the order of the scan
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @tparam Function function(color, delta, legal) returning true to stop
+     * @param vertex the vertex
+     * @param function the function
+     */
+    template <typename Problem, typename Function>
+    void for_each_move(const int vertex, Function function);
+
+    /**
+     * @brief Return true if the move of the vertex is tabu
+     */
+    [[nodiscard]] bool is_tabu(const int vertex, const int color, const long turn) const;
+
+    /**
+     * @brief Return the state of the color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    [[nodiscard]] ColorState color_state(const int color) const;
+
+    /**
+     * @brief Compute the moves of the vertex and update its leaf of the segment tree
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param vertex the vertex
+     * @param turn the current turn
+     * @param update_tree false if the segment tree is built afterwards
+     */
+    template <typename Problem>
+    void update_moves(const int vertex, const long turn, const bool update_tree);
+
+    /**
+     * @brief Compute the nodes of the segment tree from the leaves
+     */
+    void build_tree();
+
+    /**
+     * @brief Recompute the dirty vertices and the vertices whose tabu expires
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param turn the current turn
+     */
+    template <typename Problem> void refresh(const long turn);
+
+    /**
+     * @brief Mark the vertices depending on a color as dirty after a move
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param color the color
+     * @param before state of the color before the move
+     */
+    template <typename Problem>
+    void color_changed(const int color, const ColorState &before);
+
+    /**
+     * @brief Add or remove the move to a color without conflicts for the vertices not
+     * dirty, in O(1) per vertex. A vertex whose lowest delta may be the one of the
+     * removed move is marked as dirty
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param color the color created or emptied, -1 for the new color
+     * @param max_weight heaviest weight of the color (0 for the new color)
+     * @param added true if the move is added, false if removed
+     */
+    template <typename Problem>
+    void column_changed(const int color, const int max_weight, const bool added);
+
+    /**
+     * @brief Return the lowest delta of the non tabu moves and its number of moves of the
+     * vertices in [first, end)
+     */
+    [[nodiscard]] std::pair<int, int> best_moves(const std::size_t node,
+                                                 const std::size_t begin,
+                                                 const std::size_t end,
+                                                 const std::size_t first) const;
+
+    /**
+     * @brief Return the vertex of the index-th non tabu move of delta best_delta among
+     * the vertices in [first, end), the index becomes the index in the moves of the
+     * vertex
+     */
+    [[nodiscard]] int find_best(const std::size_t node,
+                                const std::size_t begin,
+                                const std::size_t end,
+                                const std::size_t first,
+                                const int best_delta,
+                                int &index) const;
+
+    /**
+     * @brief Return the last vertex with a move without conflicts of delta lower than the
+     * bound, -1 if none
+     */
+    [[nodiscard]] int last_legal(const std::size_t node,
+                                 const std::size_t begin,
+                                 const std::size_t end,
+                                 const int bound) const;
+
+    /**
+     * @brief Return the index-th non tabu move of delta best_delta of the vertex
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    [[nodiscard]] Coloration
+    nth_best_move(const int vertex, const int best_delta, const long turn, int index);
+
+  public:
+    /**
+     * @brief Construct the cache of the moves of the solution
+     *
+     * @param solution the solution searched, modified by move
+     * @param penalty_coeff coefficient of the conflicts, 0 for the legal moves only
+     * @param tabu_colors true if the vertices are tabu for a color, false for all
+     * @param max_nb_colors a new color is used only with less non empty colors
+     */
+    MoveCache(Solution &solution,
+              const int penalty_coeff,
+              const bool tabu_colors,
+              const int max_nb_colors);
+
+    MoveCache(const MoveCache &) = delete;
+    MoveCache &operator=(const MoveCache &) = delete;
+
+    /**
+     * @brief Draw one of the best moves
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param turn the current turn
+     * @param best_score a legal move reaching a lower score is taken even if tabu
+     * @param move the move drawn
+     * @return true a move is drawn
+     * @return false there is no move
+     */
+    template <typename Problem>
+    [[nodiscard]] bool best_move(const long turn, const int best_score, Coloration &move);
+
+    /**
+     * @brief Return the lowest delta of the non tabu moves
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param turn the current turn
+     * @return int the delta, the maximum int if there is no move
+     */
+    template <typename Problem> [[nodiscard]] int best_delta(const long turn);
+
+    /**
+     * @brief Draw a move among all the moves
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param turn the current turn
+     * @param move the move drawn
+     * @return true a move is drawn
+     * @return false there is no move
+     */
+    template <typename Problem>
+    [[nodiscard]] bool random_move(const long turn, Coloration &move);
+
+    /**
+     * @brief Move the vertex to the color and mark the moves depending on it as dirty
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     * @param vertex the vertex
+     * @param color its new color (-1 for a new color)
+     * @return int the old color of the vertex
+     */
+    template <typename Problem> int move(const int vertex, const int color);
+
+    /**
+     * @brief Forbid the moves of the vertex (to the color) until the turn
+     *
+     * @param vertex the vertex
+     * @param color the color (ignored if the vertex is tabu for all the colors)
+     * @param turn first turn where the move is not tabu
+     */
+    void set_tabu(const int vertex, const int color, const long turn);
+
+    /**
+     * @brief Return the number of moves with a negative delta
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> [[nodiscard]] long nb_improving(const long turn);
+
+    /**
+     * @brief Return the number of moves with a null delta
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> [[nodiscard]] long nb_neutral(const long turn);
+
+    /**
+     * @brief Return the number of moves
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> [[nodiscard]] long nb_moves(const long turn);
+};
@@ -1,124 +1,77 @@
 #pragma once
 
-#include <memory>
-#include <vector>
+#include <atomic>
+#include <cstdint>
 
+#include "../utils/spin_lock.hpp"
 #include "enum_types.hpp"
 
+/** @brief Index of a node in the arena of its tree*/
+typedef uint32_t NodeId;
+
 /**
- * @brief Representation of a node for a MCTS
+ * @brief Representation of a node for a MCTS, stored in the arena of a Tree
+ *
+ * The possible moves and the children of the node share a range of the slab of the tree
+ * (the moves in [first, first + nb_moves), the children in [first, first + nb_children)),
+ * the range has one place per possible move at the creation of the node as each child
+ * takes a move. The possible moves are a heap giving the next move to expand. The
+ * children are kept sorted by decreasing score, their rank gives their exploitation score
+ *
+ * The tree can be searched by several threads at once. The possible moves, the children,
+ * their ranks and their virtual losses are protected by the lock of the node. A thread
+ * holding the lock of a node may take the lock of a child, never the lock of the parent.
+ * The visits and the score are atomic so the parent reads them without the lock of the
+ * child
  *
  */
 class Node {
+    friend class Tree;
 
   private:
-    /** @brief Number of created nodes*/
-    static long total_nodes;
-    /** @brief Current number of nodes*/
-    static long nb_current_nodes;
-    /** @brief Height of the tree*/
-    static int height;
+    /** @brief Number of created nodes (in the trees of all the threads)*/
+    static std::atomic<long> total_nodes;
+    /** @brief Current number of nodes (in the trees of all the threads)*/
+    static std::atomic<long> nb_current_nodes;
+    /** @brief Height of the highest tree*/
+    static std::atomic<int> height;
 
-    /** @brief Pointer to parent node*/
-    Node *_parent_node;
     /** @brief Move that lead from parent node to the current node*/
-    Action _move;
-    /** @brief Possible next moves to children*/
-    std::vector<Action> _possible_moves;
-    /** @brief List of children*/
-    std::vector<std::shared_ptr<Node>> _children_nodes{};
+    Action _move{};
+    /** @brief Position of the range of the possible moves and children in the slab*/
+    uint32_t _first{0};
+    /** @brief Size of the range of the possible moves and children*/
+    uint32_t _capacity{0};
+    /** @brief Number of possible next moves to children*/
+    uint32_t _nb_moves{0};
+    /** @brief Number of children*/
+    uint32_t _nb_children{0};
+    /** @brief Number of moves taken by next_child whose child is not added yet*/
+    uint32_t _nb_expanding{0};
     /** @brief Number of visits on the node*/
-    int _visits;
+    std::atomic<int> _visits{0};
+    /** @brief Number of threads currently in a turn through the node (virtual loss)*/
+    std::atomic<int> _virtual_loss{0};
     /** @brief Score of the node*/
-    double _score{};
-    /** @brief Score exploration*/
-    double _exploration{};
-    /** @brief Score exploitation*/
-    double _exploitation{};
-    /** @brief Score UCB*/
-    double _score_ucb{};
+    std::atomic<double> _score{0};
+    /** @brief Score of the node when it was last ranked among the children of its
+     * parent*/
+    double _rank_score{};
+    /** @brief Position of the node in the children of its parent*/
+    uint32_t _rank{0};
     /** @brief Depth of the node*/
     int _depth{};
-    /** @brief ID of the node*/
-    long _id{};
+    /** @brief Score bound of the tree the possible moves and children of the node have
+     * been pruned with*/
+    int _validated{};
+    /** @brief True if the node has been removed from the tree while threads were in a
+     * turn through it, it is freed by the last of them*/
+    bool _detached{false};
+    /** @brief Protect the possible moves, the children, their ranks and their virtual
+     * losses*/
+    mutable SpinLock _lock{};
 
   public:
-    /**
-     * @brief Construct a new Node
-     *
-     * @param parent_node parent node of the new node
-     * @param move Action that lead to the new node
-     * @param possible_moves possible actions that create new children to the node
-     */
-    Node(Node *parent_node,
-         const Action &move,
-         const std::vector<Action> &possible_moves);
-
-    /**
-     * @brief Construct a copy of a Node object impossible
-     *
-     */
-    Node(const Node &) = delete;
-
-    /**
-     * @brief Destroy the Node object
-     *
-     */
-    ~Node();
-
-    /**
-     * @brief Update the branch, recalculate the score and UCB score
-     * and increment the number of visits. Delete node that lead to no children
-     *
-     * @param score new score
-     */
-    void update(const double &score);
-
-    /**
-     * @brief Delete children and possible children if their score is equal or superior to
-     * the best found score
-     *
-     * @param score best found score
-     * @return true The child node stay
-     * @return false The child node must be deleted
-     */
-    bool clean_graph(const int &score);
-
-    /**
-     * @brief Return next action of the next child of the node
-     *
-     * @return const Action next child
-     */
-    [[nodiscard]] const Action next_child();
-
-    /**
-     * @brief Add child to its parent children
-     *
-     * @param child the child to add to its parent
-     */
-    void add_child_to_parent(const std::shared_ptr<Node> &child);
-
-    /**
-     * @brief Return the move that lead to the node
-     *
-     * @return const Action& the move
-     */
-    [[nodiscard]] const Action &move() const;
-
-    /**
-     * @brief Return the UCB score of the node
-     *
-     * @return const double& the UCB score
-     */
-    [[nodiscard]] const double &score_ucb() const;
-
-    /**
-     * @brief Return the children of the node
-     *
-     * @return const std::vector<std::shared_ptr<Node>>& children node
-     */
-    [[nodiscard]] const std::vector<std::shared_ptr<Node>> &children_nodes();
-
     /**
      * @brief Get the total number of nodes created
      *
@@ -141,56 +94,18 @@ class Node {
     [[nodiscard]] static int get_height();
 
     /**
-     * @brief Get the depth of the node
-     *
-     * @return int depth of the current node
-     */
-    [[nodiscard]] int get_depth();
-
-    /**
-     * @brief A node is terminal if it has no possible child
-     *
-     * @return true the node has no child
-     * @return false the node has at least one child
-     */
-    [[nodiscard]] bool terminal() const;
-
-    /**
-     * @brief A node is fully explored if it has no child and no possible child
-     *
-     * @return true the node is fully explored
-     * @return false the branch of the node can grow
-     */
-    [[nodiscard]] bool fully_explored() const;
-
-    /**
-     * @brief Get a string representing the tree from the root node
-     *
-     * @return std::string the tree in string format
-     */
-    std::string format() const;
-
-    /**
-     * @brief Convert Node to dot format
-     *
-     * @return std::string dot string
-     */
-    std::string to_dot() const;
-
-    /**
-     * @brief Delete equal operator
+     * @brief Set the counters of a search resumed from a checkpoint, the current nodes
+     * are counted when the trees are read
      *
-     * @param node the other node
-     * @return Node& the node
+     * @param total_nodes number of nodes created
+     * @param height height of the highest tree
      */
-    Node &operator=(const Node &node) = delete;
+    static void resume_counters(const long total_nodes, const int height);
 
     /**
-     * @brief A node is superior if its score is higher
+     * @brief Get the number of created nodes as counted internally (for a checkpoint)
      *
-     * @param other the node to compare
-     * @return true other s score higher
-     * @return false other s score lower or equal
+     * @return long number of nodes created
      */
-    bool operator<(const Node &other) const;
+    [[nodiscard]] static long get_raw_total_nodes();
 };
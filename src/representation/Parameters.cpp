@@ -27,6 +27,19 @@ Parameters::Parameters(const std::string &problem_,
                        const std::string &simulation_,
                        const int O_time_,
                        const double P_time_,
+                       const std::string &neighbors_order_,
+                       const std::string &reduction_,
+                       const std::string &graph_mode_,
+                       const std::string &relabel_,
+                       const std::string &conflicts_layout_,
+                       const int nb_threads_,
+                       const std::string &parallelization_,
+                       const int nb_simulation_threads_,
+                       const int transposition_table_,
+                       const int tree_memory_,
+                       const std::string &checkpoint_,
+                       const int checkpoint_period_,
+                       const std::string &resume_,
                        const std::string &output_directory_)
     : problem(problem_),
       instance(instance_),
@@ -50,6 +63,19 @@ Parameters::Parameters(const std::string &problem_,
       simulation(simulation_),
       O_time(O_time_),
       P_time(P_time_),
+      neighbors_order(neighbors_order_),
+      reduction(reduction_),
+      graph_mode(graph_mode_),
+      relabel(relabel_),
+      conflicts_layout(conflicts_layout_),
+      nb_threads(nb_threads_),
+      parallelization(parallelization_),
+      nb_simulation_threads(nb_simulation_threads_),
+      transposition_table(transposition_table_),
+      tree_memory(tree_memory_),
+      checkpoint(checkpoint_),
+      checkpoint_period(checkpoint_period_),
+      resume(resume_),
       output_directory(output_directory_) {
     // set output file if needed
     if (output_directory != "") {
@@ -95,10 +121,29 @@ Parameters::Parameters(const std::string &problem_,
                "coeff_exploi_explo,"
                "simulation,"
                "O_time,"
-               "P_time"
+               "P_time,"
+               "neighbors_order,"
+               "graph_mode,"
+               "graph_memory_kb,"
+               "memory_kb,"
+               "reduction,"
+               "original_nb_vertices,"
+               "nb_vertices,"
+               "relabel,"
+               "conflicts_layout,"
+               "nb_threads,"
+               "parallelization,"
+               "nb_simulation_threads,"
+               "transposition_table,"
+               "tree_memory,"
+               "checkpoint,"
+               "checkpoint_period,"
+               "resume"
                "\n");
     fmt::print(output,
-               "#{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
+               "#{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},"
+               "{},{},{},{},{},{},{},{},{},{}"
+               "\n",
                get_date_str(),
                problem,
                instance,
@@ -119,7 +164,24 @@ Parameters::Parameters(const std::string &problem_,
                coeff_exploi_explo,
                simulation,
                O_time,
-               P_time);
+               P_time,
+               neighbors_order,
+               graph_mode,
+               Graph::g->memory_size() / 1024,
+               get_peak_memory_kb(),
+               reduction,
+               Graph::g->original_nb_vertices,
+               Graph::g->nb_vertices,
+               relabel,
+               conflicts_layout,
+               nb_threads,
+               parallelization,
+               nb_simulation_threads,
+               transposition_table,
+               tree_memory,
+               checkpoint,
+               checkpoint_period,
+               resume);
 }
 
 void Parameters::end_search() const {
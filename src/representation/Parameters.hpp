@@ -43,6 +43,35 @@ struct Parameters {
     const std::string simulation;
     const int O_time;
     const double P_time;
+    /** @brief Order of the neighbors of each vertex in the graph (id, weight)*/
+    const std::string neighbors_order;
+    /** @brief Reduction of the instance (none, native)*/
+    const std::string reduction;
+    /** @brief Storage of the adjacency used for the search (dense, sparse)*/
+    const std::string graph_mode;
+    /** @brief Relabelling of the vertices (none, rcm)*/
+    const std::string relabel;
+    /** @brief Layout of the conflict matrix of the solutions (vertex, color)*/
+    const std::string conflicts_layout;
+    /** @brief Number of threads of the MCTS*/
+    const int nb_threads;
+    /** @brief Parallelization of the MCTS (root : one tree per thread, tree : one tree
+     * shared by the threads)*/
+    const std::string parallelization;
+    /** @brief Number of threads running the local searches of each MCTS thread*/
+    const int nb_simulation_threads;
+    /** @brief log2 of the number of slots of the transposition table of each MCTS tree,
+     * 0 for no table*/
+    const int transposition_table;
+    /** @brief Memory budget of each MCTS tree in MB, 0 for no limit*/
+    const int tree_memory;
+    /** @brief Checkpoint file of the MCTS written at each period, empty for no
+     * checkpoint*/
+    const std::string checkpoint;
+    /** @brief Period between two checkpoints in seconds*/
+    const int checkpoint_period;
+    /** @brief Checkpoint file of the MCTS to resume from, empty to start a new search*/
+    const std::string resume;
     /** @brief Output directory name if not on console*/
     const std::string output_directory;
     /** @brief Output file name if not on console*/
@@ -86,6 +115,19 @@ struct Parameters {
                         const std::string &simulation_,
                         const int O_time_,
                         const double P_time_,
+                        const std::string &neighbors_order_,
+                        const std::string &reduction_,
+                        const std::string &graph_mode_,
+                        const std::string &relabel_,
+                        const std::string &conflicts_layout_,
+                        const int nb_threads_,
+                        const std::string &parallelization_,
+                        const int nb_simulation_threads_,
+                        const int transposition_table_,
+                        const int tree_memory_,
+                        const std::string &checkpoint_,
+                        const int checkpoint_period_,
+                        const std::string &resume_,
                         const std::string &output_directory_);
 
     /**
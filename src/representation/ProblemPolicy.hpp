@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * @brief Weighted Vertex Coloring Problem, the score of a color is the weight of its
+ * heaviest vertex
+ *
+ * The policies are given as template parameter to the solution and the local searches
+ * so the weight bookkeeping is resolved at compile time. The instantiation is chosen
+ * once at the start of the search (see Solution::weighted)
+ *
+ */
+struct ProblemWVCP {
+    /** @brief The vertices have different weights*/
+    static constexpr bool weighted = true;
+};
+
+/**
+ * @brief Graph Coloring Problem, all the weights are 1 so the score of a color is 1 if
+ * it is not empty, the weight bookkeeping is reduced to the number of vertices per color
+ *
+ */
+struct ProblemGCP {
+    /** @brief Every vertex counts as weight 1*/
+    static constexpr bool weighted = false;
+};
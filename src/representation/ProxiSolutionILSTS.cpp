@@ -53,7 +53,7 @@ int ProxiSolutionILSTS::add_to_color(const int vertex, const int color_proposed)
     const int color = _solution.add_to_color(vertex, color_proposed);
 
     // update free colors for neighbors
-    for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
+    for (const auto &neighbor : Graph::g->neighbors(vertex)) {
         if (_solution.conflicts_colors(color, neighbor) == 1 and
             Graph::g->weights[neighbor] <= old_max_weight) {
             _nb_free_colors[neighbor]--;
@@ -88,7 +88,7 @@ int ProxiSolutionILSTS::delete_from_color(const int vertex) {
     const int color = _solution.delete_from_color(vertex);
 
     // update free color for neighbors
-    for (const int neighbor : Graph::g->neighborhood[vertex]) {
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
         if (_solution.conflicts_colors(color, neighbor) == 0 and
             Graph::g->weights[neighbor] <= old_weight) {
             ++_nb_free_colors[neighbor];
@@ -169,7 +169,7 @@ void ProxiSolutionILSTS::perturb_vertices(const int force) {
         delete_from_color(vertex);
 
         std::vector<int> unassigned;
-        for (const int neighbor : Graph::g->neighborhood[vertex]) {
+        for (const int neighbor : Graph::g->neighbors(vertex)) {
             if (_solution.color(neighbor) == color) {
                 unassigned.push_back(neighbor);
                 delete_from_color(neighbor);
@@ -259,7 +259,7 @@ void ProxiSolutionILSTS::remove_unassigned_vertex(const int &vertex) {
     _unassigned.erase(std::remove(_unassigned.begin(), _unassigned.end(), vertex));
 }
 
-[[nodiscard]] Solution ProxiSolutionILSTS::solution() const {
+[[nodiscard]] const Solution &ProxiSolutionILSTS::solution() const {
     return _solution;
 }
 
@@ -139,7 +139,7 @@ class ProxiSolutionILSTS {
      */
     void remove_unassigned_vertex(const int &vertex);
 
-    [[nodiscard]] Solution solution() const;
+    [[nodiscard]] const Solution &solution() const;
 
     // Getters to original solution
 
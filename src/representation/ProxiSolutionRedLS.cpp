@@ -1,38 +1,92 @@
 #include "ProxiSolutionRedLS.hpp"
 
 #include <cassert>
+#include <limits>
+#include <random>
+#include <utility>
+
+#include "../utils/random_generator.hpp"
+
+/**
+ * @brief Return for each position in the CSR the position of the same edge in the other
+ * direction, in O(nb_edges) whatever the order of the neighbors
+ */
+static std::vector<int> reverse_edges() {
+    const Graph &graph = *Graph::g;
+    std::vector<int> reverse(graph.neighbors_list.size(), -1);
+    // for each vertex, position of the edge to it from each lower neighbor
+    std::vector<std::vector<std::tuple<int, int>>> lower_edges(graph.nb_vertices);
+    // position of the edge from the current vertex to each neighbor
+    std::vector<int> positions(graph.nb_vertices, -1);
+    for (int vertex = 0; vertex < graph.nb_vertices; ++vertex) {
+        int position = graph.neighbors_offsets[vertex];
+        for (const int neighbor : graph.neighbors(vertex)) {
+            positions[neighbor] = position;
+            if (neighbor > vertex) {
+                lower_edges[neighbor].emplace_back(vertex, position);
+            }
+            ++position;
+        }
+        for (const auto &[neighbor, position_to_vertex] : lower_edges[vertex]) {
+            reverse[position_to_vertex] = positions[neighbor];
+            reverse[positions[neighbor]] = position_to_vertex;
+        }
+    }
+    return reverse;
+}
 
 ProxiSolutionRedLS::ProxiSolutionRedLS(Solution solution)
-    : _solution(solution),
-      _conflicts_colors(solution.conflicts_colors()),
-      _edge_weights(Graph::g->nb_vertices, std::vector<int>(Graph::g->nb_vertices, 0)) {
-    // init _edge_weights
-    for (const auto &[v1, v2] : Graph::g->edges_list) {
-        _edge_weights[v1][v2] = 1;
-        _edge_weights[v2][v1] = 1;
+    : _solution(std::move(solution)),
+      _reverse_edges(reverse_edges()),
+      _edge_weights(Graph::g->neighbors_list.size(), 1),
+      _conflicts_colors(Graph::g->nb_vertices, true, std::numeric_limits<int>::max()),
+      _conflict_edges(static_cast<int>(Graph::g->neighbors_list.size())) {
+    // the edges weights start at 1, the weighted conflicts are the conflicts
+    while (_conflicts_colors.nb_colors() < _solution.nb_colors()) {
+        _conflicts_colors.add_color();
+    }
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        const int color = _solution.color(vertex);
+        if (color == -1) {
+            continue;
+        }
+        int position = Graph::g->neighbors_offsets[vertex];
+        for (const int neighbor : Graph::g->neighbors(vertex)) {
+            _conflicts_colors.increment(color, neighbor);
+            if (neighbor > vertex and _solution.color(neighbor) == color) {
+                _conflict_edges.insert(position);
+            }
+            ++position;
+        }
     }
+    _penalty = static_cast<int>(_conflict_edges.size());
+}
+
+[[nodiscard]] int ProxiSolutionRedLS::edge_key(const int vertex,
+                                               const int neighbor,
+                                               const int position) const {
+    return vertex < neighbor ? position : _reverse_edges[position];
 }
 
 int ProxiSolutionRedLS::add_to_color(const int vertex, const int proposed_color) {
     const int color = _solution.add_to_color(vertex, proposed_color);
-    if (proposed_color != color) {
-        _conflicts_colors.emplace_back(Graph::g->nb_vertices, 0);
+    while (_conflicts_colors.nb_colors() < _solution.nb_colors()) {
+        _conflicts_colors.add_color();
     }
 
-    if (_conflicts_colors[color][vertex] > 0) {
-        // Update penalty
-        _penalty += _conflicts_colors[color][vertex];
-        for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
-            if (_solution.color(neighbor) == color) {
-                const int lower = std::min(neighbor, vertex);
-                const int higher = std::max(neighbor, vertex);
-                _conflict_edges.emplace_back(std::make_tuple(lower, higher));
-            }
-        }
+    // Update penalty and conflicting edges
+    const bool conflicting = _solution.has_conflicts(vertex);
+    if (conflicting) {
+        _penalty += conflicts_colors(color, vertex);
     }
     // update conflicts for neighbors
-    for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
-        _conflicts_colors[color][neighbor] += _edge_weights[vertex][neighbor];
+    int position = Graph::g->neighbors_offsets[vertex];
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        _conflicts_colors.add(color, neighbor, _edge_weights[position]);
+        if (conflicting and _solution.color(neighbor) == color) {
+            _conflict_edges.insert(edge_key(vertex, neighbor, position));
+        }
+        ++position;
     }
 
     return color;
@@ -41,86 +95,84 @@ int ProxiSolutionRedLS::add_to_color(const int vertex, const int proposed_color)
 int ProxiSolutionRedLS::delete_from_color(const int vertex) {
     const int color = _solution.color(vertex);
 
-    // Update nb of conflicts and list of conflicting edges
-    if (_conflicts_colors[color][vertex] > 0) {
-        _penalty -= _conflicts_colors[color][vertex];
-        for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
-            if (_solution.color(neighbor) == color) {
-                const int lower = std::min(neighbor, vertex);
-                const int higher = std::max(neighbor, vertex);
-                int index = 0;
-                for (const auto &[edge1, edge2] : _conflict_edges) {
-                    if (edge1 == lower and edge2 == higher) {
-                        break;
-                    }
-                    index++;
-                }
-                _conflict_edges.erase(_conflict_edges.begin() + index);
-            }
-        }
+    // Update penalty and conflicting edges
+    const bool conflicting = _solution.has_conflicts(vertex);
+    if (conflicting) {
+        _penalty -= conflicts_colors(color, vertex);
     }
-
     // update conflicts for neighbors
-    for (const int neighbor : Graph::g->neighborhood[vertex]) {
-        // _conflicts_colors[color][neighbor]--;
-        _conflicts_colors[color][neighbor] -= _edge_weights[vertex][neighbor];
+    int position = Graph::g->neighbors_offsets[vertex];
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        _conflicts_colors.add(color, neighbor, -_edge_weights[position]);
+        if (conflicting and _solution.color(neighbor) == color) {
+            _conflict_edges.erase(edge_key(vertex, neighbor, position));
+        }
+        ++position;
     }
 
     return _solution.delete_from_color(vertex);
 }
 
 void ProxiSolutionRedLS::increment_edge_weights() {
-    for (const auto &[edge1, edge2] : _conflict_edges) {
-        ++_edge_weights[edge1][edge2];
-        ++_edge_weights[edge2][edge1];
-        ++_conflicts_colors[_solution.color(edge1)][edge2];
-        ++_conflicts_colors[_solution.color(edge2)][edge1];
+    for (const int position : _conflict_edges) {
+        const int reverse = _reverse_edges[position];
+        const int higher = Graph::g->neighbors_list[position];
+        const int lower = Graph::g->neighbors_list[reverse];
+        ++_edge_weights[position];
+        ++_edge_weights[reverse];
+        _conflicts_colors.increment(_solution.color(lower), higher);
+        _conflicts_colors.increment(_solution.color(higher), lower);
     }
     _penalty += static_cast<int>(_conflict_edges.size());
 }
 
 bool ProxiSolutionRedLS::check_solution() const {
+    int penalty = 0;
     for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
         const int color = _solution.color(vertex);
-        for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
-            if (_solution.color(neighbor) == color) {
-                const int lower = std::min(neighbor, vertex);
-                const int higher = std::max(neighbor, vertex);
-                int index = 0;
-                for (const auto &[edge1, edge2] : _conflict_edges) {
-                    if (edge1 == lower and edge2 == higher) {
-                        break;
-                    }
-                    index++;
-                }
-                assert(index < static_cast<int>(_conflict_edges.size()));
+        int position = Graph::g->neighbors_offsets[vertex];
+        for (const int neighbor : Graph::g->neighbors(vertex)) {
+            assert(_edge_weights[position] == _edge_weights[_reverse_edges[position]]);
+            if (neighbor > vertex and _solution.color(neighbor) == color) {
+                assert(_conflict_edges.contains(position));
+                penalty += _edge_weights[position];
             }
+            ++position;
         }
     }
+    assert(penalty == _penalty);
     return _solution.check_solution();
 }
 
 [[nodiscard]] int ProxiSolutionRedLS::delta_conflicts(const int vertex,
                                                       const int color) const {
-    return _conflicts_colors[color][vertex] -
-           _conflicts_colors[_solution.color(vertex)][vertex];
+    // the weighted conflicts are stored on 32 bits in the vertex major layout
+    const int *conflicts = _conflicts_colors.wide_row(vertex);
+    return conflicts[color] - conflicts[_solution.color(vertex)];
 }
 
 [[nodiscard]] int ProxiSolutionRedLS::conflicts_colors(const int &color,
                                                        const int &vertex) const {
-    return _conflicts_colors[color][vertex];
+    return _conflicts_colors.get(color, vertex);
 }
 
 [[nodiscard]] int ProxiSolutionRedLS::penalty() const {
     return _penalty;
 }
 
-[[nodiscard]] std::vector<std::tuple<int, int>>
-ProxiSolutionRedLS::conflict_edges() const {
-    return _conflict_edges;
+[[nodiscard]] bool ProxiSolutionRedLS::has_conflict_edges() const {
+    return not _conflict_edges.empty();
+}
+
+[[nodiscard]] std::tuple<int, int> ProxiSolutionRedLS::random_conflict_edge() const {
+    std::uniform_int_distribution<> dis(0, static_cast<int>(_conflict_edges.size()) - 1);
+    const int position =
+        _conflict_edges.values()[static_cast<std::size_t>(dis(rd::generator))];
+    return {Graph::g->neighbors_list[_reverse_edges[position]],
+            Graph::g->neighbors_list[position]};
 }
 
-[[nodiscard]] Solution ProxiSolutionRedLS::solution() const {
+[[nodiscard]] const Solution &ProxiSolutionRedLS::solution() const {
     return _solution;
 }
 
@@ -144,11 +196,15 @@ int ProxiSolutionRedLS::delta_wvcp_score(const int vertex, const int color) cons
     return _solution.has_conflicts(vertex);
 }
 
-[[nodiscard]] const std::set<int> &
+[[nodiscard]] const std::vector<int> &
 ProxiSolutionRedLS::colors_vertices(const int &color) const {
     return _solution.colors_vertices(color);
 }
 
+[[nodiscard]] const uint64_t *ProxiSolutionRedLS::colors_bits(const int &color) const {
+    return _solution.colors_bits(color);
+}
+
 [[nodiscard]] int ProxiSolutionRedLS::max_weight(const int &color) const {
     return _solution.max_weight(color);
 }
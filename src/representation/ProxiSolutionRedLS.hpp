@@ -1,5 +1,9 @@
 #pragma once
 
+#include <tuple>
+
+#include "../utils/sparse_set.hpp"
+#include "ConflictMatrix.hpp"
 #include "Solution.hpp"
 
 /**
@@ -7,6 +11,10 @@
  *
  * Add conflicts on edges and other way to manage of conflicts on colors
  *
+ * The edges are identified by their position in the CSR (Graph::edge_position). The
+ * weighted conflicts are stored vertex major as the moves of a vertex to all the colors
+ * are scanned
+ *
  */
 class ProxiSolutionRedLS {
 
@@ -15,13 +23,29 @@ class ProxiSolutionRedLS {
     /** @brief number of conflicts in the current solution*/
     int _penalty{0};
 
-    /** @brief For each color, for each vertex, number of neighbors in the color*/
-    std::vector<std::vector<int>> _conflicts_colors{};
-
-    /** @brief list of conflicting edges in the solution*/
-    std::vector<std::tuple<int, int>> _conflict_edges{};
-    /** @brief edge weights (for RedLS)*/
-    std::vector<std::vector<int>> _edge_weights{};
+    /** @brief For each position in the CSR, position of the same edge in the other
+     * direction*/
+    std::vector<int> _reverse_edges;
+    /** @brief edge weights (for RedLS), indexed by the position of the edge in the CSR
+     * (Graph::edge_position), each edge is stored in both directions*/
+    std::vector<int> _edge_weights;
+    /** @brief For each color, for each vertex, sum of the weights of the edges to the
+     * neighbors in the color*/
+    ConflictMatrix _conflicts_colors;
+    /** @brief conflicting edges in the solution, by the position in the CSR of the edge
+     * from the lower vertex to the higher one*/
+    SparseSet _conflict_edges;
+
+    /**
+     * @brief Return the position of the edge from the lower vertex to the higher one
+     *
+     * @param vertex first vertex
+     * @param neighbor second vertex
+     * @param position position of the edge (vertex, neighbor) in the CSR
+     */
+    [[nodiscard]] int edge_key(const int vertex,
+                               const int neighbor,
+                               const int position) const;
 
   public:
     ProxiSolutionRedLS() = delete;
@@ -41,9 +65,19 @@ class ProxiSolutionRedLS {
 
     [[nodiscard]] int penalty() const;
 
-    [[nodiscard]] std::vector<std::tuple<int, int>> conflict_edges() const;
+    /**
+     * @brief Return true if there is a conflicting edge
+     */
+    [[nodiscard]] bool has_conflict_edges() const;
 
-    [[nodiscard]] Solution solution() const;
+    /**
+     * @brief Draw a conflicting edge, there must be one
+     *
+     * @return std::tuple<int, int> the lower vertex and the higher one
+     */
+    [[nodiscard]] std::tuple<int, int> random_conflict_edge() const;
+
+    [[nodiscard]] const Solution &solution() const;
 
     // Getters to original solution
 
@@ -57,7 +91,9 @@ class ProxiSolutionRedLS {
 
     [[nodiscard]] bool has_conflicts(const int vertex) const;
 
-    [[nodiscard]] const std::set<int> &colors_vertices(const int &color) const;
+    [[nodiscard]] const std::vector<int> &colors_vertices(const int &color) const;
+
+    [[nodiscard]] const uint64_t *colors_bits(const int &color) const;
 
     [[nodiscard]] int max_weight(const int &color) const;
 
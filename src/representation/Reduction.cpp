@@ -0,0 +1,269 @@
+#include "Reduction.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <queue>
+
+/**
+ * @brief Remove the vertex from the graph and record it in the reduction
+ *
+ * @param vertex the vertex to remove
+ * @param adjacency for each alive vertex, its sorted alive neighbors
+ * @param alive for each vertex, true if not removed
+ * @param weights weight of each vertex
+ * @param reduction the reduction to update
+ */
+static void remove_vertex(const int vertex,
+                          std::vector<std::vector<int>> &adjacency,
+                          std::vector<bool> &alive,
+                          const std::vector<int> &weights,
+                          Reduction &reduction) {
+    // the neighbors alive at removal are the ones colored before the vertex when the
+    // coloring is expanded
+    reduction.removed_vertices.push_back(vertex);
+    reduction.removed_weights.push_back(weights[vertex]);
+    reduction.removed_neighbors.insert(reduction.removed_neighbors.end(),
+                                       adjacency[vertex].begin(),
+                                       adjacency[vertex].end());
+    reduction.removed_offsets.push_back(
+        static_cast<int>(reduction.removed_neighbors.size()));
+
+    for (const int neighbor : adjacency[vertex]) {
+        auto &neighbors = adjacency[neighbor];
+        neighbors.erase(std::lower_bound(neighbors.begin(), neighbors.end(), vertex));
+    }
+    adjacency[vertex].clear();
+    adjacency[vertex].shrink_to_fit();
+    alive[vertex] = false;
+}
+
+/**
+ * @brief Look for a vertex dominating the given vertex : N(vertex) included in N(u) and
+ * w(vertex) <= w(u) (u and vertex are then not neighbors)
+ *
+ * @param vertex the vertex
+ * @param adjacency for each alive vertex, its sorted alive neighbors
+ * @param weights weight of each vertex
+ * @return int the dominating vertex, -1 if there is none
+ */
+static int dominating_vertex(const int vertex,
+                             const std::vector<std::vector<int>> &adjacency,
+                             const std::vector<int> &weights) {
+    const auto &neighbors = adjacency[vertex];
+    if (neighbors.empty()) {
+        return -1;
+    }
+    // a dominating vertex is a neighbor of each neighbor, take the one with the lowest
+    // degree as candidates
+    const int pivot = *std::min_element(
+        neighbors.begin(), neighbors.end(), [&adjacency](const int v1, const int v2) {
+            return adjacency[v1].size() < adjacency[v2].size();
+        });
+    for (const int candidate : adjacency[pivot]) {
+        if (candidate == vertex or weights[candidate] < weights[vertex] or
+            adjacency[candidate].size() < neighbors.size()) {
+            continue;
+        }
+        if (std::includes(adjacency[candidate].begin(),
+                          adjacency[candidate].end(),
+                          neighbors.begin(),
+                          neighbors.end())) {
+            return candidate;
+        }
+    }
+    return -1;
+}
+
+[[nodiscard]] Reduction reduce_graph(int &nb_vertices,
+                                     std::vector<std::pair<int, int>> &edges_list,
+                                     std::vector<int> &weights) {
+    Reduction reduction;
+    reduction.original_nb_vertices = nb_vertices;
+
+    std::vector<std::vector<int>> adjacency(nb_vertices);
+    for (const auto &[v1, v2] : edges_list) {
+        if (v1 != v2) {
+            adjacency[v1].push_back(v2);
+            adjacency[v2].push_back(v1);
+        }
+    }
+    for (auto &neighbors : adjacency) {
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    // vertices by decreasing weight then decreasing degree
+    const auto heavier = [&](const int v1, const int v2) {
+        if (weights[v1] != weights[v2]) {
+            return weights[v1] > weights[v2];
+        }
+        if (adjacency[v1].size() != adjacency[v2].size()) {
+            return adjacency[v1].size() > adjacency[v2].size();
+        }
+        return v1 < v2;
+    };
+    std::vector<int> order(nb_vertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), heavier);
+
+    // greedy clique, heaviest vertices first, its weights are sorted decreasingly
+    std::vector<int> clique;
+    std::vector<int> clique_weights;
+    std::vector<bool> in_clique(nb_vertices, false);
+    for (const int vertex : order) {
+        const auto &neighbors = adjacency[vertex];
+        if (std::all_of(clique.begin(), clique.end(), [&neighbors](const int member) {
+                return std::binary_search(neighbors.begin(), neighbors.end(), member);
+            })) {
+            clique.push_back(vertex);
+            clique_weights.push_back(weights[vertex]);
+            in_clique[vertex] = true;
+        }
+    }
+
+    std::vector<bool> alive(nb_vertices, true);
+    bool reduced = true;
+    while (reduced) {
+        reduced = false;
+        for (const int vertex : order) {
+            if (not alive[vertex] or in_clique[vertex]) {
+                continue;
+            }
+            // number of colors of the clique at least as heavy as the vertex
+            const auto nb_heavier_colors = std::upper_bound(clique_weights.begin(),
+                                                            clique_weights.end(),
+                                                            weights[vertex],
+                                                            std::greater<int>()) -
+                                           clique_weights.begin();
+            if (static_cast<long>(adjacency[vertex].size()) < nb_heavier_colors or
+                dominating_vertex(vertex, adjacency, weights) != -1) {
+                remove_vertex(vertex, adjacency, alive, weights, reduction);
+                reduced = true;
+            }
+        }
+    }
+
+    // renumber the remaining vertices by decreasing weight then decreasing degree
+    std::vector<int> remaining;
+    std::copy_if(order.begin(),
+                 order.end(),
+                 std::back_inserter(remaining),
+                 [&alive](const int vertex) { return alive[vertex]; });
+    std::sort(remaining.begin(), remaining.end(), heavier);
+    std::vector<int> new_ids(nb_vertices, -1);
+    for (int i = 0; i < static_cast<int>(remaining.size()); ++i) {
+        new_ids[remaining[i]] = i;
+    }
+
+    std::vector<std::pair<int, int>> reduced_edges;
+    std::vector<int> reduced_weights;
+    reduced_weights.reserve(remaining.size());
+    for (const int vertex : remaining) {
+        reduced_weights.push_back(weights[vertex]);
+        for (const int neighbor : adjacency[vertex]) {
+            if (new_ids[vertex] < new_ids[neighbor]) {
+                reduced_edges.emplace_back(new_ids[vertex], new_ids[neighbor]);
+            }
+        }
+    }
+
+    reduction.original_ids = std::move(remaining);
+    nb_vertices = static_cast<int>(reduction.original_ids.size());
+    edges_list = std::move(reduced_edges);
+    weights = std::move(reduced_weights);
+    return reduction;
+}
+
+void relabel_graph(const int nb_vertices,
+                   std::vector<std::pair<int, int>> &edges_list,
+                   std::vector<int> &weights,
+                   Reduction &reduction) {
+    std::vector<std::vector<int>> adjacency(nb_vertices);
+    for (const auto &[v1, v2] : edges_list) {
+        if (v1 != v2) {
+            adjacency[v1].push_back(v2);
+            adjacency[v2].push_back(v1);
+        }
+    }
+    for (auto &neighbors : adjacency) {
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+    const auto lower_degree = [&adjacency](const int v1, const int v2) {
+        if (adjacency[v1].size() != adjacency[v2].size()) {
+            return adjacency[v1].size() < adjacency[v2].size();
+        }
+        return v1 < v2;
+    };
+
+    // Cuthill-McKee order, each connected component starts from a vertex of min degree
+    std::vector<int> starts(nb_vertices);
+    std::iota(starts.begin(), starts.end(), 0);
+    std::sort(starts.begin(), starts.end(), lower_degree);
+    std::vector<bool> visited(nb_vertices, false);
+    std::vector<int> cuthill_mckee;
+    cuthill_mckee.reserve(static_cast<std::size_t>(nb_vertices));
+    std::vector<int> next_neighbors;
+    for (const int start : starts) {
+        if (visited[start]) {
+            continue;
+        }
+        std::queue<int> queue;
+        queue.push(start);
+        visited[start] = true;
+        while (not queue.empty()) {
+            const int vertex = queue.front();
+            queue.pop();
+            cuthill_mckee.push_back(vertex);
+            next_neighbors.clear();
+            for (const int neighbor : adjacency[vertex]) {
+                if (not visited[neighbor]) {
+                    visited[neighbor] = true;
+                    next_neighbors.push_back(neighbor);
+                }
+            }
+            std::sort(next_neighbors.begin(), next_neighbors.end(), lower_degree);
+            for (const int neighbor : next_neighbors) {
+                queue.push(neighbor);
+            }
+        }
+    }
+    std::vector<int> rank(nb_vertices);
+    for (int i = 0; i < nb_vertices; ++i) {
+        rank[cuthill_mckee[i]] = nb_vertices - 1 - i;
+    }
+
+    // the vertices stay sorted by decreasing weight, reverse Cuthill-McKee order inside
+    // each weight
+    std::vector<int> order(nb_vertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const int v1, const int v2) {
+        if (weights[v1] != weights[v2]) {
+            return weights[v1] > weights[v2];
+        }
+        return rank[v1] < rank[v2];
+    });
+    std::vector<int> new_ids(nb_vertices);
+    for (int i = 0; i < nb_vertices; ++i) {
+        new_ids[order[i]] = i;
+    }
+
+    for (auto &[v1, v2] : edges_list) {
+        v1 = new_ids[v1];
+        v2 = new_ids[v2];
+    }
+    std::vector<int> relabelled_weights(nb_vertices);
+    std::vector<int> original_ids(nb_vertices);
+    for (int vertex = 0; vertex < nb_vertices; ++vertex) {
+        relabelled_weights[new_ids[vertex]] = weights[vertex];
+        original_ids[new_ids[vertex]] =
+            reduction.original_ids.empty() ? vertex : reduction.original_ids[vertex];
+    }
+    if (reduction.original_ids.empty()) {
+        reduction.original_nb_vertices = nb_vertices;
+    }
+    weights = std::move(relabelled_weights);
+    reduction.original_ids = std::move(original_ids);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Result of the reduction and relabelling of an instance, link between the
+ * original graph and the graph used for the search
+ *
+ * The vertices removed by the reduction can always be colored, in the reverse order of
+ * their removal, without increasing the score of a legal coloring of the reduced graph
+ *
+ */
+struct Reduction {
+    /** @brief Number of vertices of the original graph*/
+    int original_nb_vertices{0};
+    /** @brief For each vertex of the reduced graph, its id in the original graph (empty
+     * if the graph has neither been reduced nor relabelled)*/
+    std::vector<int> original_ids{};
+    /** @brief Original ids of the removed vertices, in the order of removal*/
+    std::vector<int> removed_vertices{};
+    /** @brief Weight of each removed vertex*/
+    std::vector<int> removed_weights{};
+    /** @brief CSR offsets of the neighbors of the removed vertices (nb removed + 1)*/
+    std::vector<int> removed_offsets{0};
+    /** @brief Neighbors in the original graph (original ids) of the removed vertices*/
+    std::vector<int> removed_neighbors{};
+};
+
+/**
+ * @brief Reduce the graph in place
+ *
+ * While it is possible, remove :
+ * - low degree vertices : v has less neighbors than the vertices of a clique heavier than
+ * v, a color of the clique is always available for v
+ * - dominated vertices : N(v) is included in N(u) and w(v) <= w(u), v can take the color
+ * of u
+ *
+ * The vertices of the clique are never removed. The remaining vertices are then sorted
+ * by decreasing weight then decreasing degree. With unit weights (gcp), the rules are the
+ * classic low degree (deg(v) < clique size) and domination rules.
+ *
+ * @param nb_vertices number of vertices, updated with the reduced number of vertices
+ * @param edges_list list of the edges (0 indexed), replaced by the reduced edges
+ * @param weights weight of each vertex, replaced by the reduced weights
+ * @return Reduction the link between the original and the reduced graph
+ */
+[[nodiscard]] Reduction reduce_graph(int &nb_vertices,
+                                     std::vector<std::pair<int, int>> &edges_list,
+                                     std::vector<int> &weights);
+
+/**
+ * @brief Relabel the vertices in place to improve the locality of the neighbors
+ *
+ * The vertices are numbered in reverse Cuthill-McKee order (breadth first search from a
+ * vertex of minimum degree, neighbors visited by increasing degree, order reversed)
+ * inside each group of vertices of the same weight, so the vertices stay sorted by
+ * decreasing weight
+ *
+ * @param nb_vertices number of vertices
+ * @param edges_list list of the edges (0 indexed), replaced by the relabelled edges
+ * @param weights weight of each vertex, replaced by the relabelled weights
+ * @param reduction link with the original graph, updated with the new ids
+ */
+void relabel_graph(const int nb_vertices,
+                   std::vector<std::pair<int, int>> &edges_list,
+                   std::vector<int> &weights,
+                   Reduction &reduction);
@@ -2,118 +2,356 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <numeric>
 
+#include "../utils/move_deltas.hpp"
 #include "../utils/random_generator.hpp"
 #include "../utils/utils.hpp"
 
-int Solution::best_score_wvcp = std::numeric_limits<int>::max();
-int Solution::best_nb_colors = std::numeric_limits<int>::max();
+std::atomic<int> Solution::best_score_wvcp{std::numeric_limits<int>::max()};
+std::atomic<int> Solution::best_nb_colors{std::numeric_limits<int>::max()};
 int Solution::max_nb_colors = 0;
+bool Solution::weighted = true;
+bool Solution::transposition_keys = false;
 
 const std::string Solution::header_csv = "nb_colors,penalty,score,solution";
 
-Solution::Solution() : _colors(Graph::g->nb_vertices, -1) {
+Solution::Solution()
+    : _colors(Graph::g->nb_vertices, -1),
+      _position_in_color(Graph::g->nb_vertices, -1),
+      _conflicts_colors(Graph::g->nb_vertices,
+                        Parameters::p->conflicts_layout == "vertex",
+                        Graph::g->max_degree) {
 }
 
-int Solution::add_to_color(const int vertex, int color) {
+/**
+ * @brief Return the weight of the weight rank
+ *
+ * @param rank weight rank (see Graph::weights_rank), -1 for no vertex
+ * @return int the weight, 0 for no vertex
+ */
+[[nodiscard]] static int rank_weight(const int rank) {
+    return rank == -1 ? 0 : Graph::g->distinct_weights[static_cast<std::size_t>(rank)];
+}
+
+/**
+ * @brief Mix the bits of a value (finalizer of splitmix64)
+ */
+[[nodiscard]] static uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+[[nodiscard]] uint64_t Solution::color_key(const int color) const {
+    return mix(mix(static_cast<uint64_t>(_max_weights[color])) ^ _conflict_keys[color]);
+}
+
+[[nodiscard]] bool Solution::keep_transposition_key() const {
+    return transposition_keys and not _transposition_key_paused;
+}
+
+void Solution::toggle_free_vertex(const int vertex) {
+    const uint64_t vertex_key = mix(static_cast<uint64_t>(vertex));
+    for (const int color : _non_empty_colors) {
+        if (_conflicts_colors.get(color, vertex) > 0) {
+            _colors_key -= color_key(color);
+            _conflict_keys[color] ^= vertex_key;
+            _colors_key += color_key(color);
+        }
+    }
+}
+
+void Solution::toggle_conflicts_key(const int vertex,
+                                    const int color,
+                                    const int nb_conflicts) {
+    uint64_t conflict_key = 0;
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        if (neighbor >= _first_free_vertex and
+            _conflicts_colors.get(color, neighbor) == nb_conflicts) {
+            conflict_key ^= mix(static_cast<uint64_t>(neighbor));
+        }
+    }
+    _conflict_keys[color] ^= conflict_key;
+}
+
+void Solution::add_to_weights_count(const int vertex, const int color) {
+    const std::size_t nb_ranks = Graph::g->distinct_weights.size();
+    const int rank = Graph::g->weights_rank[static_cast<std::size_t>(vertex)];
+    const std::size_t index =
+        static_cast<std::size_t>(color) * nb_ranks + static_cast<std::size_t>(rank);
+    if (++_weights_count[index] == 1) {
+        bitset_set(&_weights_bits[static_cast<std::size_t>(color) *
+                                  bitset_nb_words(static_cast<int>(nb_ranks))],
+                   rank);
+    }
+    int &heaviest = _heaviest_rank[color];
+    int &second_heaviest = _second_heaviest_rank[color];
+    if (heaviest == -1 or rank < heaviest) {
+        second_heaviest = heaviest;
+        heaviest = rank;
+        _max_weights[color] = Graph::g->weights[vertex];
+    } else if (second_heaviest == -1 or rank < second_heaviest) {
+        second_heaviest = rank;
+    }
+}
+
+void Solution::delete_from_weights_count(const int vertex, const int color) {
+    const std::size_t nb_ranks = Graph::g->distinct_weights.size();
+    const std::size_t nb_words = bitset_nb_words(static_cast<int>(nb_ranks));
+    const int rank = Graph::g->weights_rank[static_cast<std::size_t>(vertex)];
+    const int *counts = &_weights_count[static_cast<std::size_t>(color) * nb_ranks];
+    uint64_t *bits = &_weights_bits[static_cast<std::size_t>(color) * nb_words];
+    const std::size_t index =
+        static_cast<std::size_t>(color) * nb_ranks + static_cast<std::size_t>(rank);
+    if (--_weights_count[index] == 0) {
+        bitset_reset(bits, rank);
+    }
+    int &heaviest = _heaviest_rank[color];
+    int &second_heaviest = _second_heaviest_rank[color];
+    // only the removal of one of the two heaviest vertices changes them
+    if (second_heaviest != -1 and rank > second_heaviest) {
+        return;
+    }
+    heaviest = bitset_find_next(bits, nb_words, heaviest);
+    _max_weights[color] = rank_weight(heaviest);
+    if (heaviest == -1) {
+        second_heaviest = -1;
+    } else if (counts[heaviest] >= 2) {
+        second_heaviest = heaviest;
+    } else {
+        second_heaviest = bitset_find_next(bits, nb_words, heaviest + 1);
+    }
+}
+
+template <typename Problem> void Solution::create_color() {
+    _conflicts_colors.add_color();
+    _colors_bits.resize(_colors_bits.size() + bitset_nb_words(Graph::g->nb_vertices), 0);
+    _colors_vertices.emplace_back();
+    if constexpr (Problem::weighted) {
+        _weights_count.resize(_weights_count.size() + Graph::g->distinct_weights.size(),
+                              0);
+        _weights_bits.resize(
+            _weights_bits.size() +
+                bitset_nb_words(static_cast<int>(Graph::g->distinct_weights.size())),
+            0);
+        _heaviest_rank.emplace_back(-1);
+        _second_heaviest_rank.emplace_back(-1);
+    }
+    _max_weights.emplace_back(0);
+    _conflict_keys.emplace_back(0);
+    _empty_colors.push_back(_nb_colors);
+    ++_nb_colors;
+    _journal.record(JournalOp::create_color, -1, _nb_colors - 1, -1);
+}
+
+template <typename Problem> void Solution::remove_last_color() {
+    assert(_empty_colors.back() == _nb_colors - 1);
+    assert(_colors_vertices.back().empty());
+    --_nb_colors;
+    _empty_colors.pop_back();
+    _conflicts_colors.remove_color();
+    _colors_bits.resize(_colors_bits.size() - bitset_nb_words(Graph::g->nb_vertices));
+    _colors_vertices.pop_back();
+    if constexpr (Problem::weighted) {
+        _weights_count.resize(_weights_count.size() - Graph::g->distinct_weights.size());
+        _weights_bits.resize(
+            _weights_bits.size() -
+            bitset_nb_words(static_cast<int>(Graph::g->distinct_weights.size())));
+        _heaviest_rank.pop_back();
+        _second_heaviest_rank.pop_back();
+    }
+    _max_weights.pop_back();
+    _conflict_keys.pop_back();
+}
+
+void Solution::open_color(const int color) {
+    // the reused color is usually the last one
+    const auto it = std::find(_empty_colors.rbegin(), _empty_colors.rend(), color);
+    assert(it != _empty_colors.rend());
+    const auto position = std::distance(_empty_colors.begin(), it.base()) - 1;
+    _empty_colors[position] = _empty_colors.back();
+    _empty_colors.pop_back();
+    _non_empty_colors.push_back(color);
+    _journal.record(JournalOp::open_color, -1, color, static_cast<int>(position));
+}
+
+void Solution::close_color(const int color) {
+    const auto it = std::find(_non_empty_colors.begin(), _non_empty_colors.end(), color);
+    assert(it != _non_empty_colors.end());
+    const auto position = std::distance(_non_empty_colors.begin(), it);
+    _non_empty_colors[position] = _non_empty_colors.back();
+    _non_empty_colors.pop_back();
+    _empty_colors.push_back(color);
+    _journal.record(JournalOp::close_color, -1, color, static_cast<int>(position));
+}
+
+int Solution::add_to_color(const int vertex, const int color) {
+    return weighted ? add_to_color<ProblemWVCP>(vertex, color)
+                    : add_to_color<ProblemGCP>(vertex, color);
+}
+
+template <typename Problem> int Solution::add_to_color(const int vertex, int color) {
+    assert(Problem::weighted == weighted);
     assert(vertex < Graph::g->nb_vertices);
-    assert(_colors[vertex] == -1 or not _colors_vertices[color].empty());
+    assert(_colors[vertex] == -1);
 
-    // if the color is -1 (ask for a new color group)
+    // if the color is -1 (ask for a new color group), reuse an old color currently
+    // empty or create a new one
     if (color == -1) {
         if (_empty_colors.empty()) {
-            // create a new color if needed
-            _conflicts_colors.emplace_back(Graph::g->nb_vertices, 0);
-            _colors_vertices.emplace_back();
-            _heaviest_weight.emplace_back(0);
-            _non_empty_colors.push_back(_nb_colors);
-            color = _nb_colors;
-            ++_nb_colors;
-        } else {
-            // reuse an old color currently empty
-            color = _empty_colors.back();
-            _empty_colors.pop_back();
-            _non_empty_colors.push_back(color);
+            create_color<Problem>();
         }
+        color = _empty_colors.back();
     }
+    if (is_color_empty(color)) {
+        while (color >= _nb_colors) {
+            create_color<Problem>();
+        }
+        open_color(color);
+    }
+
+    insert_vertex<Problem>(vertex, color);
+    return color;
+}
 
+template <typename Problem>
+void Solution::insert_vertex(const int vertex, const int color) {
     // Update penalty
-    _penalty += _conflicts_colors[color][vertex];
+    _penalty += _conflicts_colors.get(color, vertex);
+
+    // the key of the color is replaced once the color is updated
+    const bool keep_key = keep_transposition_key();
+    if (keep_key and not _colors_vertices[color].empty()) {
+        _colors_key -= color_key(color);
+    }
 
     // update conflicts for neighbors
-    for (const auto &neighbor : Graph::g->neighborhood[vertex]) {
-        ++_conflicts_colors[color][neighbor];
+    for (const auto &neighbor : Graph::g->neighbors(vertex)) {
+        const int nb_conflicts = _conflicts_colors.increment(color, neighbor);
         // if there is a new edge in conflict
-        if (color == _colors[neighbor] and _conflicts_colors[color][neighbor] == 1) {
+        if (color == _colors[neighbor] and nb_conflicts == 1) {
             ++_nb_conflicting_vertices;
         }
     }
+    if (keep_key) {
+        toggle_conflicts_key(vertex, color, 1);
+    }
 
-    const int old_max_weight = max_weight(color);
-    const int vertex_weight = Graph::g->weights[vertex];
+    const int old_max_weight = max_weight<Problem>(color);
 
     // update vertices for the color class
-    _colors_vertices[color].insert(vertex);
+    _position_in_color[vertex] = static_cast<int>(_colors_vertices[color].size());
+    _colors_vertices[color].push_back(vertex);
+    bitset_set(&_colors_bits[static_cast<std::size_t>(color) *
+                             bitset_nb_words(Graph::g->nb_vertices)],
+               vertex);
 
     // update colors
     _colors[vertex] = color;
 
     // update score if the vertex increase the class weight
-    if (vertex_weight > old_max_weight) {
-        _score_wvcp += (vertex_weight - old_max_weight);
-        _heaviest_weight[color] = vertex_weight;
+    if constexpr (Problem::weighted) {
+        const int vertex_weight = Graph::g->weights[vertex];
+        if (vertex_weight > old_max_weight) {
+            _score_wvcp += (vertex_weight - old_max_weight);
+        }
+        add_to_weights_count(vertex, color);
+    } else {
+        // only the first vertex of the color counts
+        _score_wvcp += 1 - old_max_weight;
+        _max_weights[color] = 1;
+    }
+    if (keep_key) {
+        _colors_key += color_key(color);
     }
 
-    return color;
+    _journal.record(JournalOp::add_vertex, vertex, color, -1);
 }
 
 int Solution::delete_from_color(const int vertex) {
+    return weighted ? delete_from_color<ProblemWVCP>(vertex)
+                    : delete_from_color<ProblemGCP>(vertex);
+}
+
+template <typename Problem> int Solution::delete_from_color(const int vertex) {
+    assert(Problem::weighted == weighted);
+    const int color = remove_vertex<Problem>(vertex);
+
+    // delete color if needed
+    if (_colors_vertices[color].empty()) {
+        close_color(color);
+    }
+
+    return color;
+}
+
+template <typename Problem> int Solution::remove_vertex(const int vertex) {
     const int color = _colors[vertex];
     assert(color != -1);
     assert(vertex < Graph::g->nb_vertices);
 
     // Update conflict score
-    _penalty -= _conflicts_colors[color][vertex];
+    _penalty -= _conflicts_colors.get(color, vertex);
+
+    // the key of the color is replaced once the color is updated
+    const bool keep_key = keep_transposition_key();
+    if (keep_key) {
+        _colors_key -= color_key(color);
+    }
 
     // update conflicts for neighbors
-    for (const int neighbor : Graph::g->neighborhood[vertex]) {
-        if (color == _colors[neighbor] and _conflicts_colors[color][neighbor] == 1) {
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        if (_conflicts_colors.decrement(color, neighbor) == 0 and
+            color == _colors[neighbor]) {
             --_nb_conflicting_vertices;
         }
-        --_conflicts_colors[color][neighbor];
+    }
+    if (keep_key) {
+        toggle_conflicts_key(vertex, color, 0);
     }
 
     // update wvcp score
-    const int delta_score = delta_wvcp_score_old_color(vertex);
+    const int delta_score = delta_wvcp_score_old_color<Problem>(vertex);
 
     _score_wvcp += delta_score;
 
-    if (delta_score != 0) {
-        _heaviest_weight[color] = second_max_weight(color);
+    if constexpr (Problem::weighted) {
+        delete_from_weights_count(vertex, color);
+    }
+
+    // remove from color group, the last vertex of the color takes its place
+    const int position = _position_in_color[vertex];
+    auto &color_vertices = _colors_vertices[color];
+    const int last_vertex = color_vertices.back();
+    color_vertices[position] = last_vertex;
+    _position_in_color[last_vertex] = position;
+    color_vertices.pop_back();
+    _position_in_color[vertex] = -1;
+    if constexpr (not Problem::weighted) {
+        if (color_vertices.empty()) {
+            _max_weights[color] = 0;
+        }
     }
-
-    // remove from color group
-    _colors_vertices[color].erase(vertex);
+    bitset_reset(&_colors_bits[static_cast<std::size_t>(color) *
+                               bitset_nb_words(Graph::g->nb_vertices)],
+                 vertex);
 
     _colors[vertex] = -1;
 
-    // delete color if needed
-    if (_colors_vertices[color].empty()) {
-        const auto it =
-            std::find(_non_empty_colors.begin(), _non_empty_colors.end(), color);
-        _non_empty_colors[std::distance(_non_empty_colors.begin(), it)] =
-            _non_empty_colors.back();
-        _non_empty_colors.pop_back();
-        _empty_colors.push_back(color);
+    if (keep_key and not color_vertices.empty()) {
+        _colors_key += color_key(color);
     }
 
+    _journal.record(JournalOp::remove_vertex, vertex, color, position);
     return color;
 }
 
 [[nodiscard]] int Solution::first_available_color(const int &vertex) {
     for (const int &color : _non_empty_colors) {
-        if (_conflicts_colors[color][vertex] == 0) {
+        if (_conflicts_colors.get(color, vertex) == 0) {
             return color;
         }
     }
@@ -123,7 +361,7 @@ int Solution::delete_from_color(const int vertex) {
 [[nodiscard]] std::vector<int> Solution::available_colors(const int &vertex) const {
     std::vector<int> available_colors;
     for (const auto &color : _non_empty_colors) {
-        if (_conflicts_colors[color][vertex] == 0) {
+        if (_conflicts_colors.get(color, vertex) == 0) {
             available_colors.emplace_back(color);
         }
     }
@@ -138,7 +376,7 @@ void Solution::clean_conflicts() {
         int nb_max_conflicts = 0;
         std::vector<int> max_vertex;
         for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
-            const int nb_conflicts = _conflicts_colors[_colors[vertex]][vertex];
+            const int nb_conflicts = _conflicts_colors.get(_colors[vertex], vertex);
             if (nb_conflicts == 0) {
                 continue;
             }
@@ -161,6 +399,7 @@ void Solution::remove_one_color_and_create_conflicts() {
 
     // look for the best color group to relocate them in an
     // other color without having too much conflicts
+    const std::size_t nb_words = bitset_nb_words(Graph::g->nb_vertices);
     int best_sum_conflicts = Graph::g->nb_vertices;
     int best_color1 = -1;
     int best_color2 = -1;
@@ -170,9 +409,9 @@ void Solution::remove_one_color_and_create_conflicts() {
                 continue;
             }
             int sum_conflicts = 0;
-            for (const int vertex : _colors_vertices[color1]) {
-                sum_conflicts += _conflicts_colors[color2][vertex];
-            }
+            bitset_for_each(colors_bits(color1), nb_words, [&](const int vertex) {
+                sum_conflicts += _conflicts_colors.get(color2, vertex);
+            });
             if (sum_conflicts < best_sum_conflicts) {
                 best_color1 = color1;
                 best_color2 = color2;
@@ -181,23 +420,34 @@ void Solution::remove_one_color_and_create_conflicts() {
         }
     }
     // delete the vertices in the color and relocate them in the second color
-    const auto to_delete = _colors_vertices[best_color1];
-    for (const auto vertex : to_delete) {
+    const BitsetWords to_delete(colors_bits(best_color1),
+                                colors_bits(best_color1) + nb_words);
+    bitset_for_each(to_delete.data(), nb_words, [&](const int vertex) {
         delete_from_color(vertex);
         add_to_color(vertex, best_color2);
-    }
+    });
+}
+
+[[nodiscard]] int Solution::delta_wvcp_score_old_color(const int vertex) const {
+    return weighted ? delta_wvcp_score_old_color<ProblemWVCP>(vertex)
+                    : delta_wvcp_score_old_color<ProblemGCP>(vertex);
 }
 
+template <typename Problem>
 [[nodiscard]] int Solution::delta_wvcp_score_old_color(const int vertex) const {
     const int color = _colors[vertex];
+    if constexpr (not Problem::weighted) {
+        // the color is lost if the vertex was the only one in the color
+        return _colors_vertices[color].size() == 1 ? -1 : 0;
+    }
     const int vertex_weight = Graph::g->weights[vertex];
     // if the vertex was the only one in the color
     if (_colors_vertices[color].size() == 1) {
         return -vertex_weight;
     }
     // if the vertex is the heaviest one and the second heaviest is lighter
-    const int second_max = second_max_weight(color);
-    if (vertex_weight == max_weight(color) and second_max < vertex_weight) {
+    const int second_max = second_max_weight<Problem>(color);
+    if (vertex_weight == max_weight<Problem>(color) and second_max < vertex_weight) {
         return second_max - vertex_weight;
     }
     // else
@@ -205,17 +455,27 @@ void Solution::remove_one_color_and_create_conflicts() {
 }
 
 [[nodiscard]] int Solution::delta_wvcp_score(const int vertex, const int color) const {
-    const int vertex_weight = Graph::g->weights[vertex];
+    return weighted ? delta_wvcp_score<ProblemWVCP>(vertex, color)
+                    : delta_wvcp_score<ProblemGCP>(vertex, color);
+}
+
+template <typename Problem>
+[[nodiscard]] int Solution::delta_wvcp_score(const int vertex, const int color) const {
     int diff = 0;
     // if the vertex already have a color
     if (_colors[vertex] != -1) {
-        diff = delta_wvcp_score_old_color(vertex);
+        diff = delta_wvcp_score_old_color<Problem>(vertex);
     }
     // if the new color is empty
     if (color == -1 or is_color_empty(color)) {
-        return vertex_weight + diff;
+        return (Problem::weighted ? Graph::g->weights[vertex] : 1) + diff;
+    }
+    if constexpr (not Problem::weighted) {
+        // all the vertices have the same weight, adding it to a color changes nothing
+        return diff;
     }
-    const int old_max_weight = max_weight(color);
+    const int vertex_weight = Graph::g->weights[vertex];
+    const int old_max_weight = max_weight<Problem>(color);
     // if the vertex is heavier than the heaviest of the new color class
     if (vertex_weight > old_max_weight) {
         // the delta is the difference between the vertex weight and the heavier
@@ -225,15 +485,146 @@ void Solution::remove_one_color_and_create_conflicts() {
     return diff;
 }
 
+void Solution::delta_moves(const int vertex,
+                           const int penalty_coeff,
+                           int *deltas,
+                           int *conflicts) const {
+    if (weighted) {
+        delta_moves<ProblemWVCP>(vertex, penalty_coeff, deltas, conflicts);
+    } else {
+        delta_moves<ProblemGCP>(vertex, penalty_coeff, deltas, conflicts);
+    }
+}
+
+template <typename Problem>
+void Solution::delta_moves(const int vertex,
+                           const int penalty_coeff,
+                           int *deltas,
+                           int *conflicts) const {
+    assert(_colors[vertex] != -1);
+    const int weight = Problem::weighted ? Graph::g->weights[vertex] : 1;
+    const int base = delta_wvcp_score_old_color<Problem>(vertex) -
+                     penalty_coeff * _conflicts_colors.get(_colors[vertex], vertex);
+    if (not _conflicts_colors.vertex_major()) {
+        // the counts of the vertex are not contiguous
+        for (int color = 0; color < _nb_colors; ++color) {
+            const int nb_conflicts = _conflicts_colors.get(color, vertex);
+            conflicts[color] = nb_conflicts;
+            deltas[color] = base + std::max(weight - _max_weights[color], 0) +
+                            penalty_coeff * nb_conflicts;
+        }
+    } else if (_conflicts_colors.narrow()) {
+        move_deltas(_max_weights.data(),
+                    _conflicts_colors.narrow_row(vertex),
+                    _nb_colors,
+                    weight,
+                    base,
+                    penalty_coeff,
+                    deltas,
+                    conflicts);
+    } else {
+        move_deltas(_max_weights.data(),
+                    _conflicts_colors.wide_row(vertex),
+                    _nb_colors,
+                    weight,
+                    base,
+                    penalty_coeff,
+                    deltas,
+                    conflicts);
+    }
+}
+
 [[nodiscard]] int Solution::delta_conflicts(const int vertex, const int color) const {
     if (color == -1) {
-        return -_conflicts_colors[_colors[vertex]][vertex];
+        return -_conflicts_colors.get(_colors[vertex], vertex);
     }
-    return _conflicts_colors[color][vertex] - _conflicts_colors[_colors[vertex]][vertex];
+    return _conflicts_colors.get(color, vertex) -
+           _conflicts_colors.get(_colors[vertex], vertex);
 }
 
 void Solution::increment_first_free_vertex() {
+    if (keep_transposition_key()) {
+        toggle_free_vertex(_first_free_vertex);
+    }
     ++_first_free_vertex;
+    _journal.record(JournalOp::increment_first_free_vertex, -1, -1, -1);
+}
+
+void Solution::pause_transposition_key() {
+    if (not keep_transposition_key()) {
+        return;
+    }
+    // a color emptied then removed during the pause loses its key, it is restored with
+    // the others when the pause is undone
+    _paused_conflict_keys = _conflict_keys;
+    _transposition_key_paused = true;
+    _journal.record(JournalOp::pause_transposition_key, -1, -1, -1);
+}
+
+std::size_t Solution::checkpoint() {
+    _journal.set_recording(true);
+    return _journal.size();
+}
+
+bool Solution::rollback(const std::size_t checkpoint) {
+    if (not _journal.recording() or _journal.size() < checkpoint) {
+        return false;
+    }
+    // the undo operations must not be recorded
+    _journal.set_recording(false);
+    while (_journal.size() > checkpoint) {
+        if (weighted) {
+            undo<ProblemWVCP>(_journal.pop());
+        } else {
+            undo<ProblemGCP>(_journal.pop());
+        }
+    }
+    _journal.set_recording(true);
+    return true;
+}
+
+template <typename Problem> void Solution::undo(const JournalEntry &entry) {
+    switch (entry.op) {
+    case JournalOp::add_vertex:
+        // the vertex is the last one of the color, its removal moves no vertex
+        remove_vertex<Problem>(entry.vertex);
+        break;
+    case JournalOp::remove_vertex: {
+        // the vertex comes back at the end of the color then takes back its position
+        insert_vertex<Problem>(entry.vertex, entry.color);
+        auto &color_vertices = _colors_vertices[entry.color];
+        const int moved_vertex = color_vertices[entry.position];
+        color_vertices[entry.position] = entry.vertex;
+        color_vertices.back() = moved_vertex;
+        _position_in_color[moved_vertex] = static_cast<int>(color_vertices.size()) - 1;
+        _position_in_color[entry.vertex] = entry.position;
+        break;
+    }
+    case JournalOp::create_color:
+        remove_last_color<Problem>();
+        break;
+    case JournalOp::open_color:
+        _non_empty_colors.pop_back();
+        _empty_colors.push_back(entry.color);
+        std::swap(_empty_colors[entry.position], _empty_colors.back());
+        break;
+    case JournalOp::close_color:
+        _empty_colors.pop_back();
+        _non_empty_colors.push_back(entry.color);
+        std::swap(_non_empty_colors[entry.position], _non_empty_colors.back());
+        break;
+    case JournalOp::increment_first_free_vertex:
+        --_first_free_vertex;
+        if (keep_transposition_key()) {
+            toggle_free_vertex(_first_free_vertex);
+        }
+        break;
+    case JournalOp::pause_transposition_key:
+        // the solution is back to its state at the pause, the keys were left unchanged
+        _conflict_keys = _paused_conflict_keys;
+        _transposition_key_paused = false;
+        break;
+    }
 }
 
 void Solution::reorganize_colors() {
@@ -278,12 +669,50 @@ bool Solution::check_solution() const {
 
         assert(max_weight(color) == max_colors_weights[color]);
         score += max_colors_weights[color];
+
+        // the weight counts are incrementally updated, check them against the vertices
+        std::vector<int> color_weights;
+        for (const int vertex : _colors_vertices[color]) {
+            assert(_colors[vertex] == color);
+            assert(_colors_vertices[color][_position_in_color[vertex]] == vertex);
+            color_weights.push_back(Graph::g->weights[vertex]);
+        }
+        std::sort(color_weights.begin(), color_weights.end(), std::greater<int>());
+        assert(second_max_weight(color) ==
+               (color_weights.size() > 1 ? color_weights[1] : 0));
+    }
+
+#ifndef NDEBUG
+    // the conflicts are incrementally updated, check them against the adjacency matrix
+    for (int color = 0; color < _nb_colors; ++color) {
+        for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+            assert(_conflicts_colors.get(color, vertex) ==
+                   count_conflicts(color, vertex));
+        }
     }
+    // the keys of the colors are incrementally updated, check them against the conflicts
+    if (keep_transposition_key()) {
+        uint64_t colors_key = 0;
+        for (const int color : _non_empty_colors) {
+            uint64_t conflict_key = 0;
+            for (int vertex = _first_free_vertex; vertex < Graph::g->nb_vertices;
+                 ++vertex) {
+                if (_conflicts_colors.get(color, vertex) > 0) {
+                    conflict_key ^= mix(static_cast<uint64_t>(vertex));
+                }
+            }
+            assert(_conflict_keys[color] == conflict_key);
+            colors_key += color_key(color);
+        }
+        assert(_colors_key == colors_key);
+    }
+#endif
 
     for (const int &color : _empty_colors) {
         (void)color;
         assert(max_colors_weights[color] == 0);
-        assert(_heaviest_weight[color] == 0);
+        assert(not weighted or _heaviest_rank[color] == -1);
+        assert(max_weight(color) == 0);
         assert(_colors_vertices[color].empty());
     }
 
@@ -291,25 +720,39 @@ bool Solution::check_solution() const {
     return true;
 }
 
+[[nodiscard]] int Solution::max_weight(const int &color) const {
+    return weighted ? max_weight<ProblemWVCP>(color) : max_weight<ProblemGCP>(color);
+}
+
+template <typename Problem>
 [[nodiscard]] int Solution::max_weight(const int &color) const {
     if (color == -1 or color >= _nb_colors) {
         return 0;
     }
-    return _heaviest_weight[color];
+    return _max_weights[color];
 }
 
 [[nodiscard]] int Solution::second_max_weight(const int &color) const {
-    if (color == -1 or color >= _nb_colors or _colors_vertices[color].size() <= 1) {
+    return weighted ? second_max_weight<ProblemWVCP>(color)
+                    : second_max_weight<ProblemGCP>(color);
+}
+
+template <typename Problem>
+[[nodiscard]] int Solution::second_max_weight(const int &color) const {
+    if (color == -1 or color >= _nb_colors) {
         return 0;
     }
-    return Graph::g->weights[*(++_colors_vertices[color].begin())];
+    if constexpr (not Problem::weighted) {
+        return _colors_vertices[color].size() > 1 ? 1 : 0;
+    }
+    return rank_weight(_second_heaviest_rank[color]);
 }
 
 [[nodiscard]] bool Solution::has_conflicts(const int vertex) const {
     if (_colors[vertex] == -1) {
         return 0;
     }
-    return _conflicts_colors[_colors[vertex]][vertex] != 0;
+    return _conflicts_colors.get(_colors[vertex], vertex) != 0;
 }
 
 [[nodiscard]] bool Solution::is_color_empty(const int color) const {
@@ -321,7 +764,7 @@ bool Solution::check_solution() const {
                        _non_empty_colors.size(),
                        _penalty,
                        _score_wvcp,
-                       fmt::join(_colors, ":"));
+                       fmt::join(Graph::g->original_colors(_colors), ":"));
 }
 
 [[nodiscard]] const std::vector<int> &Solution::colors() const {
@@ -345,10 +788,28 @@ bool Solution::check_solution() const {
 }
 
 [[nodiscard]] int Solution::conflicts_colors(const int &color, const int &vertex) const {
-    return _conflicts_colors[color][vertex];
+    return _conflicts_colors.get(color, vertex);
+}
+
+[[nodiscard]] int Solution::count_conflicts(const int color, const int vertex) const {
+    const uint64_t *color_bits = colors_bits(color);
+    if (Graph::g->adjacency_matrix) {
+        return popcount_and(
+            Graph::g->adjacency_row(vertex), color_bits, Graph::g->adjacency_row_words);
+    }
+    int nb_conflicts = 0;
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        nb_conflicts += bitset_test(color_bits, neighbor);
+    }
+    return nb_conflicts;
+}
+
+[[nodiscard]] const uint64_t *Solution::colors_bits(const int &color) const {
+    return &_colors_bits[static_cast<std::size_t>(color) *
+                         bitset_nb_words(Graph::g->nb_vertices)];
 }
 
-[[nodiscard]] const std::set<int> &Solution::colors_vertices(const int &color) const {
+[[nodiscard]] const std::vector<int> &Solution::colors_vertices(const int &color) const {
     return _colors_vertices[color];
 }
 
@@ -364,6 +825,11 @@ bool Solution::check_solution() const {
     return _first_free_vertex;
 }
 
+[[nodiscard]] uint64_t Solution::transposition_key() const {
+    assert(keep_transposition_key());
+    return mix(mix(static_cast<uint64_t>(_first_free_vertex)) + _colors_key);
+}
+
 [[nodiscard]] std::vector<int>
 Solution::nb_vertices_per_color(const int nb_colors_max) const {
     std::vector<int> nb_colors_per_col(nb_colors_max, 0);
@@ -385,14 +851,46 @@ Solution::nb_vertices_per_color(const int nb_colors_max) const {
     return weights;
 }
 
-[[nodiscard]] const std::vector<std::vector<int>> &Solution::conflicts_colors() const {
-    return _conflicts_colors;
-}
-
 int Solution::nb_conflicting_vertices() const {
     return _nb_conflicting_vertices;
 }
 
+SolutionSnapshot::SolutionSnapshot(const Solution &solution)
+    : _colors(solution.colors()),
+      _score_wvcp(solution.score_wvcp()),
+      _penalty(solution.penalty()) {
+}
+
+void SolutionSnapshot::save(const Solution &solution) {
+    std::copy(solution.colors().begin(), solution.colors().end(), _colors.begin());
+    _score_wvcp = solution.score_wvcp();
+    _penalty = solution.penalty();
+}
+
+void SolutionSnapshot::restore(Solution &solution) const {
+    // uncolor all the vertices to move first, so a color can be emptied then reused
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        if (solution.color(vertex) != _colors[vertex] and solution.color(vertex) != -1) {
+            solution.delete_from_color(vertex);
+        }
+    }
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        if (solution.color(vertex) != _colors[vertex]) {
+            solution.add_to_color(vertex, _colors[vertex]);
+        }
+    }
+    assert(solution.score_wvcp() == _score_wvcp);
+    assert(solution.penalty() == _penalty);
+}
+
+[[nodiscard]] int SolutionSnapshot::score_wvcp() const {
+    return _score_wvcp;
+}
+
+[[nodiscard]] int SolutionSnapshot::penalty() const {
+    return _penalty;
+}
+
 [[nodiscard]] int distance_approximation(const Solution &sol1, const Solution &sol2) {
     const int max_k = std::max(sol1.nb_colors(), sol2.nb_colors()) + 1;
     std::vector<std::vector<int>> same_color(max_k, std::vector<int>(max_k, 0));
@@ -483,3 +981,26 @@ int Solution::nb_conflicting_vertices() const {
 
     return Graph::g->nb_vertices - proxi;
 }
+
+template int Solution::add_to_color<ProblemWVCP>(const int vertex, int color);
+template int Solution::add_to_color<ProblemGCP>(const int vertex, int color);
+template int Solution::delete_from_color<ProblemWVCP>(const int vertex);
+template int Solution::delete_from_color<ProblemGCP>(const int vertex);
+template int Solution::delta_wvcp_score<ProblemWVCP>(const int vertex,
+                                                     const int color) const;
+template int Solution::delta_wvcp_score<ProblemGCP>(const int vertex,
+                                                    const int color) const;
+template void Solution::delta_moves<ProblemWVCP>(const int vertex,
+                                                 const int penalty_coeff,
+                                                 int *deltas,
+                                                 int *conflicts) const;
+template void Solution::delta_moves<ProblemGCP>(const int vertex,
+                                                const int penalty_coeff,
+                                                int *deltas,
+                                                int *conflicts) const;
+template int Solution::delta_wvcp_score_old_color<ProblemWVCP>(const int vertex) const;
+template int Solution::delta_wvcp_score_old_color<ProblemGCP>(const int vertex) const;
+template int Solution::max_weight<ProblemWVCP>(const int &color) const;
+template int Solution::max_weight<ProblemGCP>(const int &color) const;
+template int Solution::second_max_weight<ProblemWVCP>(const int &color) const;
+template int Solution::second_max_weight<ProblemGCP>(const int &color) const;
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
-#include <set>
 #include <tuple>
 
+#include "../utils/bitset.hpp"
+#include "ConflictMatrix.hpp"
 #include "Graph.hpp"
 #include "Parameters.hpp"
+#include "ProblemPolicy.hpp"
+#include "SolutionJournal.hpp"
 
 /**
  * @brief Representation of a solution for Weighted Vertex Coloring Problem
@@ -13,25 +17,51 @@
  */
 class Solution {
   public:
-    /** @brief WVCP best found score*/
-    static int best_score_wvcp;
+    /** @brief WVCP best found score (shared by the threads of the search)*/
+    static std::atomic<int> best_score_wvcp;
     /** @brief Minimal nb of color found (you have to update it)*/
-    static int best_nb_colors;
+    static std::atomic<int> best_nb_colors;
     /** @brief Max number of color for fixed nb_colors methods (you have to update it) */
     static int max_nb_colors;
     /** @brief Header csv*/
     const static std::string header_csv;
+    /** @brief True for the WVCP, false for the GCP (all weights at 1), chooses the
+     * instantiation used by the non template methods, set once at the start*/
+    static bool weighted;
+    /** @brief True if the solutions keep their transposition key (transposition table
+     * of the MCTS), set once at the start*/
+    static bool transposition_keys;
 
   private:
     /** @brief For each vertex, its color*/
     std::vector<int> _colors{};
-    /** @brief For each color, set of the vertices colored with the color*/
-    std::vector<std::set<int>> _colors_vertices{};
-    /** @brief For each color, the heaviest weight*/
-    std::vector<int> _heaviest_weight{};
+    /** @brief For each color, the vertices colored with the color (in no particular
+     * order, a deletion moves the last vertex of the color in place of the deleted one)*/
+    std::vector<std::vector<int>> _colors_vertices{};
+    /** @brief For each vertex, its position in the vertices of its color*/
+    std::vector<int> _position_in_color{};
+
+    /** @brief For each color, for each weight rank (see Graph::weights_rank), number of
+     * vertices in the color (one row of distinct_weights.size() values per color)*/
+    std::vector<int> _weights_count{};
+    /** @brief For each color, bitset of the weight ranks present in the color (one row
+     * of bitset_nb_words(distinct_weights.size()) words per color)*/
+    BitsetWords _weights_bits{};
+    /** @brief For each color, weight rank of the heaviest vertex (-1 if empty)*/
+    std::vector<int> _heaviest_rank{};
+    /** @brief For each color, weight rank of the second heaviest vertex (-1 if less than
+     * 2 vertices), equal to _heaviest_rank if the heaviest weight is shared*/
+    std::vector<int> _second_heaviest_rank{};
+    /** @brief For each color, weight of the heaviest vertex (0 if empty, 1 for the GCP),
+     * contiguous for the evaluation of the moves to all the colors*/
+    std::vector<int> _max_weights{};
 
     /** @brief For each color, for each vertex, number of neighbors in the color*/
-    std::vector<std::vector<int>> _conflicts_colors{};
+    ConflictMatrix _conflicts_colors{};
+
+    /** @brief For each color, bitset of the vertices in the color (one row of
+     * bitset_nb_words(nb_vertices) words per color)*/
+    BitsetWords _colors_bits{};
 
     /** @brief number of opened colors (not automaticaly all used)*/
     int _nb_colors{0};
@@ -43,6 +73,16 @@ class Solution {
     /** @brief Next vertex to color in the MCTS tree*/
     int _first_free_vertex{0};
 
+    /** @brief For each color, xor of the keys of the free vertices in conflict with the
+     * color (if transposition_keys)*/
+    std::vector<uint64_t> _conflict_keys{};
+    /** @brief Sum of the keys of the non empty colors (if transposition_keys)*/
+    uint64_t _colors_key{0};
+    /** @brief True if the keys are no longer updated since pause_transposition_key*/
+    bool _transposition_key_paused{false};
+    /** @brief Keys of the colors when the update was paused*/
+    std::vector<uint64_t> _paused_conflict_keys{};
+
     /** @brief WVCP score*/
     int _score_wvcp{0};
 
@@ -51,6 +91,117 @@ class Solution {
     /** @brief number of conflicting vertices*/
     int _nb_conflicting_vertices{0};
 
+    /** @brief Changes since the checkpoints (not copied with the solution)*/
+    SolutionJournal _journal{};
+
+    /**
+     * @brief Add the vertex to the weight counts of the color and update the heaviest
+     * and second heaviest ranks of the color
+     *
+     * @param vertex the vertex added to the color
+     * @param color the color
+     */
+    void add_to_weights_count(const int vertex, const int color);
+
+    /**
+     * @brief Remove the vertex from the weight counts of the color and update the
+     * heaviest and second heaviest ranks of the color
+     *
+     * @param vertex the vertex removed from the color
+     * @param color the color
+     */
+    void delete_from_weights_count(const int vertex, const int color);
+
+    /**
+     * @brief Return the key of the color, from its heaviest weight and the free vertices
+     * in conflict with it
+     *
+     * @param color the color
+     * @return uint64_t the key
+     */
+    [[nodiscard]] uint64_t color_key(const int color) const;
+
+    /**
+     * @brief Add or remove the vertex from the keys of the colors in conflict with it,
+     * when it enters or leaves the free vertices
+     *
+     * @param vertex the vertex
+     */
+    void toggle_free_vertex(const int vertex);
+
+    /**
+     * @brief Add or remove the free neighbors of the vertex from the key of the color,
+     * once the vertex is added to the color (they have now 1 conflict with it) or
+     * removed from it (0 conflict)
+     *
+     * @param vertex the vertex
+     * @param color the color
+     * @param nb_conflicts number of conflicts of the neighbors entering or leaving the
+     * conflicts with the color
+     */
+    void toggle_conflicts_key(const int vertex, const int color, const int nb_conflicts);
+
+    /**
+     * @brief Return true if the transposition key is updated with the moves
+     */
+    [[nodiscard]] bool keep_transposition_key() const;
+
+    /**
+     * @brief Append the vertex to the vertices of the color (the color must be in the
+     * non empty colors, even if it has no vertex yet)
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP
+     * @param vertex the vertex to color, currently uncolored
+     * @param color the color
+     */
+    template <typename Problem> void insert_vertex(const int vertex, const int color);
+
+    /**
+     * @brief Remove the vertex from its color, the color stays in the non empty colors
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP
+     * @param vertex the vertex to uncolor
+     * @return int the old color
+     */
+    template <typename Problem> int remove_vertex(const int vertex);
+
+    /**
+     * @brief Create a new color, added to the empty colors
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP (no weight counts for the GCP)
+     */
+    template <typename Problem> void create_color();
+
+    /**
+     * @brief Remove the last created color, it must be the last empty color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP
+     */
+    template <typename Problem> void remove_last_color();
+
+    /**
+     * @brief Move the empty color to the non empty colors
+     *
+     * @param color the color
+     */
+    void open_color(const int color);
+
+    /**
+     * @brief Move the color without vertex to the empty colors
+     *
+     * @param color the color
+     */
+    void close_color(const int color);
+
+    /**
+     * @brief Undo a change recorded in the journal, the solution must be in the state
+     * right after the change
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP
+     * @param entry the change
+     */
+    template <typename Problem> void undo(const JournalEntry &entry);
+
   public:
     /**
      * @brief Construct a new Solution object
@@ -66,15 +217,21 @@ class Solution {
 
     /**
      * @brief Color the vertex to the color
-     * if the color is not created, the color is created
-     * if the vertex is already colored, the vertex is uncolored before colored
-     * with the color
+     * if the color is not created or empty, the color is created or reused
+     * the vertex must be uncolored (see delete_from_color)
      *
      * @param vertex the vertex to color
      * @param color the color to use (-1 to ask for a new color)
      * @return int the color used
      */
-    int add_to_color(const int vertex, int color);
+    int add_to_color(const int vertex, const int color);
+
+    /**
+     * @brief Color the vertex to the color, see add_to_color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> int add_to_color(const int vertex, int color);
 
     /**
      * @brief Remove color of a vertex
@@ -84,6 +241,13 @@ class Solution {
      */
     int delete_from_color(const int vertex);
 
+    /**
+     * @brief Remove color of a vertex, see delete_from_color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> int delete_from_color(const int vertex);
+
     /**
      * @brief Give the first available color for the given vertex,
      * -1 if no color available
@@ -112,6 +276,44 @@ class Solution {
      */
     [[nodiscard]] int delta_wvcp_score(const int vertex, const int color) const;
 
+    /**
+     * @brief Compute the difference on the score if the vertex is colored with the
+     * color, see delta_wvcp_score
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    [[nodiscard]] int delta_wvcp_score(const int vertex, const int color) const;
+
+    /**
+     * @brief Compute the deltas of the moves of the vertex to all the colors at once
+     *
+     * For each color c < nb_colors (empty or not), deltas[c] = delta_wvcp_score(vertex,
+     * c) + penalty_coeff * delta_conflicts(vertex, c) and conflicts[c] =
+     * conflicts_colors(c, vertex). The value of the color of the vertex is meaningless
+     *
+     * @param vertex the vertex, must be colored
+     * @param penalty_coeff coefficient of the conflicts
+     * @param deltas for each color, delta of the move (nb_colors values)
+     * @param conflicts for each color, conflicts of the vertex (nb_colors values)
+     */
+    void delta_moves(const int vertex,
+                     const int penalty_coeff,
+                     int *deltas,
+                     int *conflicts) const;
+
+    /**
+     * @brief Compute the deltas of the moves of the vertex to all the colors at once,
+     * see delta_moves
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    void delta_moves(const int vertex,
+                     const int penalty_coeff,
+                     int *deltas,
+                     int *conflicts) const;
+
     /**
      * @brief Compute the difference on the score if the vertex lost its color
      *
@@ -120,6 +322,15 @@ class Solution {
      */
     [[nodiscard]] int delta_wvcp_score_old_color(const int vertex) const;
 
+    /**
+     * @brief Compute the difference on the score if the vertex lost its color, see
+     * delta_wvcp_score_old_color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    [[nodiscard]] int delta_wvcp_score_old_color(const int vertex) const;
+
     /**
      * @brief Compute the difference on the conflicts if the vertex is colored with the
      * color
@@ -136,6 +347,32 @@ class Solution {
      */
     void increment_first_free_vertex();
 
+    /**
+     * @brief Start recording the changes of the solution (if not already) and return a
+     * checkpoint to come back to the current state with rollback
+     *
+     * @return std::size_t the checkpoint
+     */
+    std::size_t checkpoint();
+
+    /**
+     * @brief Undo the changes made since the checkpoint, in O(number of changes). The
+     * solution comes back exactly to the state of the checkpoint (including the order
+     * of the colors). The checkpoints are lost if the solution is assigned
+     *
+     * @param checkpoint the checkpoint given by checkpoint()
+     * @return true the solution is back to the checkpoint
+     * @return false the checkpoint is lost, the solution is unchanged
+     */
+    bool rollback(const std::size_t checkpoint);
+
+    /**
+     * @brief Stop updating the transposition key until a rollback comes back before this
+     * point (only recorded after a checkpoint), for the moves of the simulation which
+     * are never looked up in the transposition table
+     */
+    void pause_transposition_key();
+
     /**
      * @brief all used colors are the firsts ones
      *
@@ -158,6 +395,13 @@ class Solution {
      */
     [[nodiscard]] int max_weight(const int &color) const;
 
+    /**
+     * @brief Return max weight of the color, see max_weight
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem> [[nodiscard]] int max_weight(const int &color) const;
+
     /**
      * @brief Return the second max weight of the color
      *
@@ -166,6 +410,14 @@ class Solution {
      */
     [[nodiscard]] int second_max_weight(const int &color) const;
 
+    /**
+     * @brief Return the second max weight of the color, see second_max_weight
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP, must match Solution::weighted
+     */
+    template <typename Problem>
+    [[nodiscard]] int second_max_weight(const int &color) const;
+
     /**
      * @brief Return whether the vertex has conflict or not
      *
@@ -184,7 +436,8 @@ class Solution {
     [[nodiscard]] bool is_color_empty(const int color) const;
 
     /**
-     * @brief Return the solution in csv format
+     * @brief Return the solution in csv format, the colors are given for the vertices of
+     * the original graph
      *
      * @return std::string the solution in csv format
      */
@@ -233,13 +486,31 @@ class Solution {
      */
     [[nodiscard]] int conflicts_colors(const int &color, const int &vertex) const;
 
+    /**
+     * @brief Recompute the number of neighbors of the vertex in the color with the
+     * packed adjacency matrix, popcount(adjacency[vertex] & color bitset)
+     *
+     * @param color the color
+     * @param vertex the vertex
+     * @return int number of neighbors of the vertex in the color
+     */
+    [[nodiscard]] int count_conflicts(const int color, const int vertex) const;
+
+    /**
+     * @brief Return the bitset of the vertices in the color
+     *
+     * @param color given color
+     * @return const uint64_t* bitset_nb_words(nb_vertices) words
+     */
+    [[nodiscard]] const uint64_t *colors_bits(const int &color) const;
+
     /**
      * @brief Return vertices in given color
      *
      * @param color given color
-     * @return std::set<int> vertices in the color
+     * @return const std::vector<int>& vertices in the color, in no particular order
      */
-    [[nodiscard]] const std::set<int> &colors_vertices(const int &color) const;
+    [[nodiscard]] const std::vector<int> &colors_vertices(const int &color) const;
 
     /**
      * @brief Return non empty colors
@@ -255,6 +526,18 @@ class Solution {
      */
     [[nodiscard]] int first_free_vertex() const;
 
+    /**
+     * @brief Return the key of the partial solution for the transposition table, kept
+     * with the moves (transposition_keys must be set)
+     *
+     * The key depends on the next vertex to color and for each non empty color, on its
+     * heaviest weight and the free vertices in conflict with it, whatever the indices of
+     * the colors and their order
+     *
+     * @return uint64_t the key
+     */
+    [[nodiscard]] uint64_t transposition_key() const;
+
     /**
      * @brief Get the number of non_empty colors
      *
@@ -277,11 +560,63 @@ class Solution {
      */
     [[nodiscard]] std::vector<std::vector<int>> weights() const;
 
-    [[nodiscard]] const std::vector<std::vector<int>> &conflicts_colors() const;
-
     int nb_conflicting_vertices() const;
 };
 
+/**
+ * @brief Copy of the colors of a solution, lighter than a copy of the solution to keep
+ * the best solution of a search (no conflict matrix nor color lists). The solution is
+ * rebuilt from it only when needed
+ *
+ */
+class SolutionSnapshot {
+  private:
+    /** @brief For each vertex, its color*/
+    std::vector<int> _colors;
+    /** @brief WVCP score*/
+    int _score_wvcp;
+    /** @brief number of conflicts (conflicting edges)*/
+    int _penalty;
+
+  public:
+    /**
+     * @brief Construct a snapshot of the solution
+     *
+     * @param solution the solution
+     */
+    explicit SolutionSnapshot(const Solution &solution);
+
+    /**
+     * @brief Replace the snapshot with the solution, in O(nb_vertices) without
+     * allocation
+     *
+     * @param solution the solution
+     */
+    void save(const Solution &solution);
+
+    /**
+     * @brief Give the colors of the snapshot to the solution, only the vertices with a
+     * different color are moved
+     *
+     * @param solution the solution to modify
+     */
+    void restore(Solution &solution) const;
+
+    /**
+     * @brief Return the score of the snapshot
+     *
+     * @return int the score
+     */
+    [[nodiscard]] int score_wvcp() const;
+
+    /**
+     * @brief Return the number of conflicts of the snapshot
+     *
+     * @return int penalty
+     */
+    [[nodiscard]] int penalty() const;
+};
+
 /**
  * @brief Compute an approximation of the distance between two solutions
  *
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** @brief Elementary change of a solution recorded in its journal*/
+enum class JournalOp : uint8_t {
+    /** @brief the vertex is appended to the vertices of the color*/
+    add_vertex,
+    /** @brief the vertex is removed from the color at the given position*/
+    remove_vertex,
+    /** @brief a new color is created (empty)*/
+    create_color,
+    /** @brief the color is moved from the empty colors (at the given position) to the
+       non empty colors*/
+    open_color,
+    /** @brief the color is moved from the non empty colors (at the given position) to
+       the empty colors*/
+    close_color,
+    /** @brief the next vertex to color in the MCTS tree is incremented*/
+    increment_first_free_vertex,
+    /** @brief the transposition key is no longer updated*/
+    pause_transposition_key,
+};
+
+/**
+ * @brief Elementary change of a solution with what is needed to undo it
+ *
+ */
+struct JournalEntry {
+    /** @brief the change*/
+    JournalOp op;
+    /** @brief vertex concerned (-1 if none)*/
+    int vertex;
+    /** @brief color concerned (-1 if none)*/
+    int color;
+    /** @brief position of the vertex in the color or of the color in the list it left
+     * (-1 if none)*/
+    int position;
+};
+
+/**
+ * @brief Journal of the changes of a solution since its checkpoints
+ *
+ * The changes are only recorded after a checkpoint. A copy of a solution doesn't share
+ * its history : copying a journal gives an empty journal that doesn't record, and
+ * assigning a solution stops the recording of the assigned one (its checkpoints are
+ * lost)
+ *
+ */
+class SolutionJournal {
+  private:
+    /** @brief Recorded changes, the last one at the end*/
+    std::vector<JournalEntry> _entries{};
+    /** @brief True if the changes are recorded*/
+    bool _recording{false};
+
+  public:
+    SolutionJournal() = default;
+
+    SolutionJournal(const SolutionJournal &) {
+    }
+
+    SolutionJournal &operator=(const SolutionJournal &) {
+        _entries.clear();
+        _recording = false;
+        return *this;
+    }
+
+    SolutionJournal(SolutionJournal &&) = default;
+
+    SolutionJournal &operator=(SolutionJournal &&) = default;
+
+    ~SolutionJournal() = default;
+
+    /**
+     * @brief Record the change if the journal is recording
+     */
+    void record(const JournalOp op, const int vertex, const int color, const int position) {
+        if (_recording) {
+            _entries.push_back(JournalEntry{op, vertex, color, position});
+        }
+    }
+
+    /**
+     * @brief Start or stop the recording of the changes
+     */
+    void set_recording(const bool recording) {
+        _recording = recording;
+    }
+
+    /**
+     * @brief Return true if the changes are recorded
+     */
+    [[nodiscard]] bool recording() const {
+        return _recording;
+    }
+
+    /**
+     * @brief Return the number of recorded changes
+     */
+    [[nodiscard]] std::size_t size() const {
+        return _entries.size();
+    }
+
+    /**
+     * @brief Remove and return the last recorded change
+     */
+    JournalEntry pop() {
+        const JournalEntry entry = _entries.back();
+        _entries.pop_back();
+        return entry;
+    }
+};
@@ -0,0 +1,188 @@
+#include "TabuColEngine.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <random>
+
+#include "../utils/random_generator.hpp"
+#include "Graph.hpp"
+
+TabuColEngine::TabuColEngine(Solution &solution)
+    : _solution(solution),
+      _conflicting_vertices(Graph::g->nb_vertices),
+      _moves(static_cast<std::size_t>(Graph::g->nb_vertices),
+             VertexMoves{0, 0, 0, 0, -1}) {
+}
+
+void TabuColEngine::restart() {
+    if (_solution.nb_colors() != _nb_colors) {
+        _nb_colors = _solution.nb_colors();
+        _tabu.assign(static_cast<std::size_t>(Graph::g->nb_vertices) *
+                         static_cast<std::size_t>(_nb_colors),
+                     0);
+        _deltas.resize(static_cast<std::size_t>(_nb_colors));
+        _conflicts.resize(static_cast<std::size_t>(_nb_colors));
+    }
+    // the tenures of the previous searches are expired
+    _turn = _last_tabu;
+    for (int vertex = 0; vertex < Graph::g->nb_vertices; ++vertex) {
+        _moves[static_cast<std::size_t>(vertex)].valid_until = -1;
+        if (_solution.has_conflicts(vertex)) {
+            _conflicting_vertices.insert(vertex);
+        } else {
+            _conflicting_vertices.erase(vertex);
+        }
+    }
+    _nb_non_empty_colors = _solution.non_empty_colors().size();
+}
+
+void TabuColEngine::next_turn() {
+    ++_turn;
+}
+
+void TabuColEngine::update_moves(const int vertex) {
+    VertexMoves &moves = _moves[static_cast<std::size_t>(vertex)];
+    moves = VertexMoves{std::numeric_limits<int>::max(),
+                        0,
+                        std::numeric_limits<int>::max(),
+                        0,
+                        std::numeric_limits<long>::max()};
+    const int vertex_color = _solution.color(vertex);
+    const long *tabu = _tabu.data() + static_cast<std::size_t>(vertex) *
+                                          static_cast<std::size_t>(_nb_colors);
+    // the deltas of the score are not used
+    _solution.delta_moves(vertex, 0, _deltas.data(), _conflicts.data());
+    const int vertex_conflicts = _conflicts[static_cast<std::size_t>(vertex_color)];
+    for (const int color : _solution.non_empty_colors()) {
+        if (color == vertex_color) {
+            continue;
+        }
+        const int delta = _conflicts[static_cast<std::size_t>(color)] - vertex_conflicts;
+        if (tabu[color] >= _turn) {
+            moves.valid_until = std::min(moves.valid_until, tabu[color]);
+            if (delta < moves.best_tabu_delta) {
+                moves.best_tabu_delta = delta;
+                moves.nb_best_tabu = 0;
+            }
+            if (delta == moves.best_tabu_delta) {
+                ++moves.nb_best_tabu;
+            }
+            continue;
+        }
+        if (delta < moves.best_delta) {
+            moves.best_delta = delta;
+            moves.nb_best = 0;
+        }
+        if (delta == moves.best_delta) {
+            ++moves.nb_best;
+        }
+    }
+}
+
+[[nodiscard]] bool TabuColEngine::best_move(const int best_found, Coloration &move) {
+    // a color emptied changes the moves of all the vertices
+    if (_solution.non_empty_colors().size() != _nb_non_empty_colors) {
+        _nb_non_empty_colors = _solution.non_empty_colors().size();
+        for (auto &moves : _moves) {
+            moves.valid_until = -1;
+        }
+    }
+    const int penalty = _solution.penalty();
+    int best_delta = std::numeric_limits<int>::max();
+    int nb_best = 0;
+    _best_vertices.clear();
+    for (const int vertex : _conflicting_vertices) {
+        VertexMoves &moves = _moves[static_cast<std::size_t>(vertex)];
+        if (moves.valid_until < _turn) {
+            update_moves(vertex);
+        }
+        int vertex_delta = moves.best_delta;
+        int vertex_nb_best = moves.nb_best;
+        // a tabu move is allowed if it improves the best penalty
+        if (moves.nb_best_tabu > 0 and penalty + moves.best_tabu_delta < best_found) {
+            if (moves.best_tabu_delta < vertex_delta) {
+                vertex_delta = moves.best_tabu_delta;
+                vertex_nb_best = 0;
+            }
+            if (moves.best_tabu_delta == vertex_delta) {
+                vertex_nb_best += moves.nb_best_tabu;
+            }
+        }
+        if (vertex_nb_best == 0 or vertex_delta > best_delta) {
+            continue;
+        }
+        if (vertex_delta < best_delta) {
+            best_delta = vertex_delta;
+            nb_best = 0;
+            _best_vertices.clear();
+        }
+        nb_best += vertex_nb_best;
+        _best_vertices.push_back(vertex);
+    }
+    if (nb_best == 0) {
+        return false;
+    }
+
+    // the moves are numbered in the order of the scan of the vertices and the colors
+    std::sort(_best_vertices.begin(), _best_vertices.end());
+    std::uniform_int_distribution<> distribution(0, nb_best - 1);
+    int index = distribution(rd::generator);
+    for (const int vertex : _best_vertices) {
+        const int vertex_color = _solution.color(vertex);
+        const int vertex_conflicts = _solution.conflicts_colors(vertex_color, vertex);
+        const long *tabu = _tabu.data() + static_cast<std::size_t>(vertex) *
+                                              static_cast<std::size_t>(_nb_colors);
+        for (const int color : _solution.non_empty_colors()) {
+            const int delta =
+                _solution.conflicts_colors(color, vertex) - vertex_conflicts;
+            if (color == vertex_color or delta != best_delta or
+                (tabu[color] >= _turn and penalty + delta >= best_found)) {
+                continue;
+            }
+            if (index == 0) {
+                move = Coloration{vertex, color};
+                return true;
+            }
+            --index;
+        }
+    }
+    assert(false);
+    return false;
+}
+
+void TabuColEngine::vertex_moved(const int vertex) {
+    _moves[static_cast<std::size_t>(vertex)].valid_until = -1;
+    if (_solution.has_conflicts(vertex)) {
+        _conflicting_vertices.insert(vertex);
+    } else {
+        _conflicting_vertices.erase(vertex);
+    }
+    for (const int neighbor : Graph::g->neighbors(vertex)) {
+        _moves[static_cast<std::size_t>(neighbor)].valid_until = -1;
+        if (_solution.has_conflicts(neighbor)) {
+            _conflicting_vertices.insert(neighbor);
+        } else {
+            _conflicting_vertices.erase(neighbor);
+        }
+    }
+}
+
+template <typename Problem> int TabuColEngine::move(const int vertex, const int color) {
+    const int old_color = _solution.delete_from_color<Problem>(vertex);
+    _solution.add_to_color<Problem>(vertex, color);
+    assert(_solution.nb_colors() == _nb_colors);
+    vertex_moved(vertex);
+    return old_color;
+}
+
+void TabuColEngine::set_tabu(const int vertex, const int color, const long tenure) {
+    const long last_turn = _turn + tenure;
+    _tabu[static_cast<std::size_t>(vertex) * static_cast<std::size_t>(_nb_colors) +
+          static_cast<std::size_t>(color)] = last_turn;
+    _last_tabu = std::max(_last_tabu, last_turn);
+    _moves[static_cast<std::size_t>(vertex)].valid_until = -1;
+}
+
+template int TabuColEngine::move<ProblemWVCP>(const int vertex, const int color);
+template int TabuColEngine::move<ProblemGCP>(const int vertex, const int color);
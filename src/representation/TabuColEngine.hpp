@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+
+#include "../utils/sparse_set.hpp"
+#include "Solution.hpp"
+#include "enum_types.hpp"
+
+/**
+ * @brief Moves of TabuCol maintained incrementally on a solution
+ *
+ * A move colors a conflicting vertex with another non empty color, its delta is the
+ * difference of conflicts of the vertex between the two colors. Moving a vertex only
+ * changes the conflicts of its neighbors, so the engine keeps :
+ * - the list of the conflicting vertices, updated for the vertex and its neighbors
+ * - for each vertex, the best delta of its non tabu moves and of its tabu moves (with the
+ * number of moves reaching them), recomputed only when the vertex or a neighbor moves,
+ * when the set of non empty colors changes or when one of its tabu moves expires
+ * - the tabu tenures in one array for the whole search, the turns keep on increasing
+ * between the restarts so the old tenures are expired without clearing the array
+ *
+ * The best move is drawn among the moves of lowest delta in the order of a scan of the
+ * vertices and of the non empty colors, with the same draw as rd::choice, so the search
+ * is the one of the scan of all the moves
+ *
+ */
+class TabuColEngine {
+  private:
+    /** @brief Best moves of a vertex*/
+    struct VertexMoves {
+        /** @brief Lowest delta of the non tabu moves*/
+        int best_delta;
+        /** @brief Number of non tabu moves with the lowest delta*/
+        int nb_best;
+        /** @brief Lowest delta of the tabu moves*/
+        int best_tabu_delta;
+        /** @brief Number of tabu moves with the lowest delta*/
+        int nb_best_tabu;
+        /** @brief Last turn before a tabu move expires, -1 if the moves must be
+         * recomputed*/
+        long valid_until;
+    };
+
+    /** @brief The solution searched*/
+    Solution &_solution;
+    /** @brief Vertices with conflicts*/
+    SparseSet _conflicting_vertices;
+    /** @brief Number of colors of the tabu array*/
+    int _nb_colors{0};
+    /** @brief For each vertex, for each color, last turn where the move is tabu*/
+    std::vector<long> _tabu{};
+    /** @brief Current turn, never reset*/
+    long _turn{0};
+    /** @brief Highest turn of the tabu array*/
+    long _last_tabu{0};
+    /** @brief Best moves of each vertex*/
+    std::vector<VertexMoves> _moves{};
+    /** @brief Number of non empty colors when the moves were computed*/
+    std::size_t _nb_non_empty_colors{0};
+    /** @brief Vertices with a move of the lowest delta (buffer of best_move)*/
+    std::vector<int> _best_vertices{};
+    /** @brief For each color, delta of the move of a vertex (buffer of update_moves)*/
+    std::vector<int> _deltas{};
+    /** @brief For each color, conflicts of a vertex (buffer of update_moves)*/
+    std::vector<int> _conflicts{};
+
+    /**
+     * @brief Compute the best moves of the vertex
+     *
+     * @param vertex the vertex
+     */
+    void update_moves(const int vertex);
+
+    /**
+     * @brief Recompute the moves of the vertex and its neighbors at the next selection
+     * and update their conflicts
+     *
+     * @param vertex the vertex moved
+     */
+    void vertex_moved(const int vertex);
+
+  public:
+    /**
+     * @brief Construct the engine of the solution, restart must be called before the
+     * first selection
+     *
+     * @param solution the solution searched, modified by move
+     */
+    explicit TabuColEngine(Solution &solution);
+
+    TabuColEngine(const TabuColEngine &) = delete;
+    TabuColEngine &operator=(const TabuColEngine &) = delete;
+
+    /**
+     * @brief Start a new search on the solution (modified outside of the engine), no
+     * move is tabu
+     *
+     */
+    void restart();
+
+    /**
+     * @brief Start the next turn
+     *
+     */
+    void next_turn();
+
+    /**
+     * @brief Draw one of the best moves, a tabu move is allowed if it gives a penalty
+     * lower than the best one
+     *
+     * @param best_found best penalty since the restart
+     * @param move the move drawn
+     * @return true a move is drawn
+     * @return false all the moves are tabu
+     */
+    [[nodiscard]] bool best_move(const int best_found, Coloration &move);
+
+    /**
+     * @brief Move the vertex to the color
+     *
+     * @tparam Problem ProblemWVCP or ProblemGCP
+     * @param vertex the vertex
+     * @param color its new color
+     * @return int the old color of the vertex
+     */
+    template <typename Problem> int move(const int vertex, const int color);
+
+    /**
+     * @brief Forbid the color for the vertex during the next turns
+     *
+     * @param vertex the vertex
+     * @param color the color
+     * @param tenure number of turns
+     */
+    void set_tabu(const int vertex, const int color, const long tenure);
+};
@@ -0,0 +1,44 @@
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <mutex>
+
+TranspositionTable::TranspositionTable(const int size_log2)
+    : _entries(std::size_t{1} << size_log2, Entry{0, std::numeric_limits<int>::max()}),
+      _mask((uint64_t{1} << size_log2) - 1),
+      _locks(std::make_unique<SpinLock[]>(nb_locks)) {
+    assert(Solution::transposition_keys);
+}
+
+[[nodiscard]] bool TranspositionTable::dominated(const Solution &solution) {
+    const uint64_t solution_key = solution.transposition_key();
+    const int score = solution.score_wvcp();
+    const uint64_t slot = solution_key & _mask;
+    const std::lock_guard<SpinLock> lock(_locks[slot % nb_locks]);
+    Entry &entry = _entries[slot];
+    if (entry.key == solution_key and entry.score <= score) {
+        return true;
+    }
+    entry = Entry{solution_key, score};
+    return false;
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < nb_locks; ++i) {
+        _locks[i].lock();
+    }
+    std::fill(_entries.begin(), _entries.end(), Entry{0, std::numeric_limits<int>::max()});
+    for (std::size_t i = 0; i < nb_locks; ++i) {
+        _locks[i].unlock();
+    }
+}
+
+[[nodiscard]] std::shared_mutex &TranspositionTable::expansion_mutex() {
+    return _expansion_mutex;
+}
+
+[[nodiscard]] std::size_t TranspositionTable::memory_size() const {
+    return _entries.capacity() * sizeof(Entry) + nb_locks * sizeof(SpinLock);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "../utils/spin_lock.hpp"
+#include "Solution.hpp"
+
+/**
+ * @brief Partial solutions of a MCTS tree already reached, to skip the moves leading to a
+ * partial solution equivalent to one already in the tree
+ *
+ * The vertices are colored in a fixed order, so the tree can't reach twice the same
+ * partition of the colored vertices. But the rest of the search only depends on the
+ * colors seen from the vertices to color : for each color, the heaviest weight and the
+ * free vertices in conflict with the color. Two partial solutions with the same colors
+ * seen this way (whatever their order or indices) have the same next moves and the same
+ * deltas of score, the one with the higher score is dominated and its branch is useless.
+ * The solutions keep their key with the moves (see Solution::transposition_key)
+ *
+ * The table keeps one entry per slot (the last one) with a hash of 64 bits, a collision
+ * may prune a branch wrongly. The slots are protected by a set of locks so the threads
+ * of a shared tree can use the same table
+ *
+ * A partial solution evicted from the tree (memory budget) must be reachable again, the
+ * table is cleared after an eviction. The expansions hold the expansion mutex (shared)
+ * and the eviction with the clearing holds it (exclusive) so an evicted partial solution
+ * is never skipped because of its own entry
+ *
+ */
+class TranspositionTable {
+  private:
+    /** @brief Number of locks protecting the slots*/
+    static constexpr std::size_t nb_locks = 256;
+
+    /** @brief Partial solution reached*/
+    struct Entry {
+        /** @brief Key of the partial solution*/
+        uint64_t key;
+        /** @brief Lowest score reached with the key*/
+        int score;
+    };
+
+    /** @brief Slots of the table*/
+    std::vector<Entry> _entries;
+    /** @brief Mask of the slot of a key*/
+    uint64_t _mask;
+    /** @brief Locks of the slots*/
+    std::unique_ptr<SpinLock[]> _locks;
+    /** @brief Shared by the expansions of the tree, exclusive for the evictions*/
+    std::shared_mutex _expansion_mutex{};
+
+  public:
+    /**
+     * @brief Construct an empty table
+     *
+     * @param size_log2 log2 of the number of slots
+     */
+    explicit TranspositionTable(const int size_log2);
+
+    /**
+     * @brief Check if an equivalent partial solution with a lower or equal score has been
+     * reached, if not record the partial solution
+     *
+     * @param solution partial solution colored until its first free vertex
+     * @return true the partial solution is dominated, its branch can be skipped
+     * @return false the partial solution is new or better, it is recorded
+     */
+    [[nodiscard]] bool dominated(const Solution &solution);
+
+    /**
+     * @brief Forget all the partial solutions (they may have been removed from the tree
+     * and must be reachable again)
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Return the mutex held (shared) during the expansions of the tree and
+     * (exclusive) during the evictions of subtrees with the clearing of the table
+     *
+     * @return std::shared_mutex& the mutex
+     */
+    [[nodiscard]] std::shared_mutex &expansion_mutex();
+
+    /**
+     * @brief Return the memory used by the table in bytes
+     */
+    [[nodiscard]] std::size_t memory_size() const;
+};
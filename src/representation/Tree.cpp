@@ -0,0 +1,647 @@
+#include "Tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+#include "../utils/random_generator.hpp"
+#include "Graph.hpp"
+#include "Parameters.hpp"
+
+namespace {
+/**
+ * @brief Return the log2 of the size of the chunks of the slab, a chunk must hold the
+ * range of a node (at most one possible move per color, one more color than vertices)
+ */
+int slab_shift() {
+    int shift = 14;
+    while ((uint64_t{1} << shift) < static_cast<uint64_t>(Graph::g->nb_vertices) + 1) {
+        ++shift;
+    }
+    return shift;
+}
+} // namespace
+
+Tree::Tree(const Action &move, const std::vector<Action> &possible_moves)
+    : _nodes(14), _slab(slab_shift()), _root(allocate(0, move, possible_moves)) {
+}
+
+Tree::Tree(BinaryReader &reader)
+    : _nodes(14), _slab(slab_shift()), _root(no_node), _bound(reader.read<int>()) {
+    _root = load(0, reader);
+}
+
+Tree::~Tree() {
+    Node::nb_current_nodes -= _nb_nodes;
+}
+
+[[nodiscard]] std::size_t Tree::node_memory(const uint32_t capacity) {
+    return sizeof(Node) + capacity * sizeof(SlabEntry);
+}
+
+NodeId Tree::allocate(const int depth,
+                      const Action &move,
+                      const std::vector<Action> &possible_moves) {
+    const auto capacity = static_cast<uint32_t>(possible_moves.size());
+    NodeId id;
+    uint32_t first = 0;
+    {
+        const std::lock_guard<SpinLock> lock(_arena_lock);
+        if (_free_nodes.empty()) {
+            id = _nodes.grow(1);
+        } else {
+            id = _free_nodes.back();
+            _free_nodes.pop_back();
+        }
+        if (capacity > 0) {
+            first = allocate_range(capacity);
+        }
+        ++_nb_nodes;
+        const std::size_t memory = _memory += node_memory(capacity);
+        if (memory > _peak_memory) {
+            _peak_memory = memory;
+        }
+    }
+    Node &node = _nodes[id];
+    node._move = move;
+    node._first = first;
+    node._capacity = capacity;
+    node._nb_moves = capacity;
+    node._nb_children = 0;
+    node._nb_expanding = 0;
+    node._visits = 0;
+    node._virtual_loss = 0;
+    node._score = 0;
+    // a new child is ranked last until its first update
+    node._rank_score = -std::numeric_limits<double>::infinity();
+    node._rank = 0;
+    node._depth = depth;
+    // the possible moves are checked against the bound at the first selection
+    node._validated = std::numeric_limits<int>::max();
+    node._detached = false;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        _slab[first + i].move = possible_moves[i];
+    }
+
+    int current_height = Node::height;
+    while (depth > current_height and
+           not Node::height.compare_exchange_weak(current_height, depth)) {
+    }
+    ++Node::total_nodes;
+    ++Node::nb_current_nodes;
+    return id;
+}
+
+uint32_t Tree::allocate_range(const uint32_t capacity) {
+    const auto range = _free_sizes.lower_bound({capacity, 0});
+    if (range == _free_sizes.end()) {
+        return _slab.grow(capacity);
+    }
+    const auto [size, first] = *range;
+    _free_sizes.erase(range);
+    _free_ranges.erase(first);
+    // the rest of the free range stays free
+    if (size > capacity) {
+        _free_ranges.emplace(first + capacity, size - capacity);
+        _free_sizes.emplace(size - capacity, first + capacity);
+    }
+    return first;
+}
+
+void Tree::release_range(uint32_t first, uint32_t capacity) {
+    auto next = _free_ranges.lower_bound(first);
+    if (next != _free_ranges.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == first) {
+            first = previous->first;
+            capacity += previous->second;
+            _free_sizes.erase({previous->second, previous->first});
+            _free_ranges.erase(previous);
+        }
+    }
+    if (next != _free_ranges.end() and first + capacity == next->first) {
+        capacity += next->second;
+        _free_sizes.erase({next->second, next->first});
+        _free_ranges.erase(next);
+    }
+    _free_ranges.emplace(first, capacity);
+    _free_sizes.emplace(capacity, first);
+}
+
+void Tree::release(const std::vector<NodeId> &nodes) {
+    if (nodes.empty()) {
+        return;
+    }
+    const std::lock_guard<SpinLock> lock(_arena_lock);
+    for (const NodeId id : nodes) {
+        const Node &node = _nodes[id];
+        _memory -= node_memory(node._capacity);
+        if (node._capacity > 0) {
+            release_range(node._first, node._capacity);
+        }
+        _free_nodes.push_back(id);
+    }
+    _nb_nodes -= static_cast<long>(nodes.size());
+    Node::nb_current_nodes -= static_cast<long>(nodes.size());
+}
+
+void Tree::detach(const NodeId node, std::vector<NodeId> &freed) {
+    Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    for (uint32_t i = 0; i < n._nb_children; ++i) {
+        detach(_slab[n._first + i].child, freed);
+    }
+    n._nb_children = 0;
+    n._nb_moves = 0;
+    // the virtual loss is only added with the lock of the parent, held by the caller
+    if (n._virtual_loss == 0) {
+        freed.push_back(node);
+    } else {
+        n._detached = true;
+    }
+}
+
+[[nodiscard]] NodeId Tree::root() const {
+    return _root;
+}
+
+void Tree::enter_root() {
+    ++_nodes[_root]._virtual_loss;
+}
+
+[[nodiscard]] double Tree::score_ucb(const Node &parent,
+                                   const Node &child,
+                                   const double sum_rank,
+                                   const double log_visits) const {
+    // the children are sorted by decreasing score, the best one has the highest rank
+    const double exploitation = (child._rank + 1) / sum_rank;
+    const int child_visits = child._visits;
+    const int virtual_loss = child._virtual_loss;
+    if (virtual_loss == 0) {
+        const double exploration = std::sqrt(2 * log_visits / child_visits);
+        return exploitation + Parameters::p->coeff_exploi_explo * exploration;
+    }
+    // the turns in progress count as visits with no exploitation
+    const int visits = child_visits + virtual_loss;
+    const int parent_visits = parent._visits + parent._virtual_loss;
+    const double exploration = std::sqrt(2 * std::log(parent_visits) / visits);
+    return exploitation * child_visits / visits +
+           Parameters::p->coeff_exploi_explo * exploration;
+}
+
+void Tree::validate(Node &node, std::vector<NodeId> &freed) {
+    const int bound = _bound;
+    if (node._validated <= bound) {
+        return;
+    }
+    node._validated = bound;
+    // delete possible children with a too high score
+    uint32_t nb_moves = 0;
+    for (uint32_t i = 0; i < node._nb_moves; ++i) {
+        const Action &move = _slab[node._first + i].move;
+        if (move.score < bound) {
+            _slab[node._first + nb_moves].move = move;
+            ++nb_moves;
+        }
+    }
+    if (nb_moves < node._nb_moves) {
+        node._nb_moves = nb_moves;
+        make_heap(node);
+    }
+    // delete children with a too high score
+    uint32_t nb_children = 0;
+    for (uint32_t i = 0; i < node._nb_children; ++i) {
+        const NodeId child = _slab[node._first + i].child;
+        if (_nodes[child]._move.score >= bound) {
+            detach(child, freed);
+        } else {
+            _slab[node._first + nb_children].child = child;
+            _nodes[child]._rank = nb_children;
+            ++nb_children;
+        }
+    }
+    node._nb_children = nb_children;
+}
+
+[[nodiscard]] bool Tree::select_child(const NodeId node, NodeId &child) {
+    thread_local std::vector<NodeId> next_nodes;
+    std::vector<NodeId> freed;
+    bool found = false;
+    {
+        Node &n = _nodes[node];
+        const std::lock_guard<SpinLock> lock(n._lock);
+        validate(n, freed);
+        while (not found and n._nb_children > 0) {
+            const double sum_rank =
+                static_cast<double>(uint64_t{n._nb_children} * (n._nb_children + 1)) / 2;
+            const int visits = n._visits;
+            const double log_visits = std::log(visits);
+            double max_score = std::numeric_limits<double>::min();
+            next_nodes.clear();
+            for (uint32_t i = 0; i < n._nb_children; ++i) {
+                const NodeId id = _slab[n._first + i].child;
+                const double score = score_ucb(n, _nodes[id], sum_rank, log_visits);
+                if (score > max_score) {
+                    max_score = score;
+                    next_nodes.clear();
+                    next_nodes.push_back(id);
+                } else if (score == max_score) {
+                    next_nodes.push_back(id);
+                }
+            }
+            if (next_nodes.empty()) {
+                break;
+            }
+            child = rd::choice(next_nodes);
+            Node &c = _nodes[child];
+            {
+                const std::lock_guard<SpinLock> child_lock(c._lock);
+                validate(c, freed);
+                found = c._nb_moves > 0 or c._nb_children > 0 or c._nb_expanding > 0;
+                if (found) {
+                    // under the lock of the parent so the child can't be freed meanwhile
+                    ++c._virtual_loss;
+                }
+            }
+            if (not found) {
+                // nothing left under the child after the pruning
+                remove_child(n, c._rank);
+                detach(child, freed);
+            }
+        }
+    }
+    release(freed);
+    return found;
+}
+
+[[nodiscard]] bool Tree::next_child(const NodeId node, Action &move) {
+    Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    if (n._nb_moves == 0) {
+        return false;
+    }
+    move = _slab[n._first].move;
+    if (move.score >= _bound) {
+        // the best move has been pruned since the selection, the other ones too
+        n._nb_moves = 0;
+        return false;
+    }
+    --n._nb_moves;
+    if (n._nb_moves > 0) {
+        sift_down(n, 0, _slab[n._first + n._nb_moves].move);
+    }
+    // the node is not fully explored until the child is added or skipped
+    ++n._nb_expanding;
+    return true;
+}
+
+void Tree::skip_child(const NodeId node) {
+    Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    --n._nb_expanding;
+}
+
+void Tree::sift_down(const Node &node, uint32_t position, const Action &move) {
+    // the next move is at the top of the heap (ordered by compare_actions)
+    while (true) {
+        uint32_t next = 2 * position + 1;
+        if (next >= node._nb_moves) {
+            break;
+        }
+        if (next + 1 < node._nb_moves and
+            compare_actions(_slab[node._first + next].move,
+                            _slab[node._first + next + 1].move)) {
+            ++next;
+        }
+        if (not compare_actions(move, _slab[node._first + next].move)) {
+            break;
+        }
+        _slab[node._first + position].move = _slab[node._first + next].move;
+        position = next;
+    }
+    _slab[node._first + position].move = move;
+}
+
+void Tree::push_move(Node &node, const Action &move) {
+    // the moves that must be taken after the new one go down
+    uint32_t position = node._nb_moves;
+    ++node._nb_moves;
+    while (position > 0) {
+        const uint32_t parent = (position - 1) / 2;
+        if (not compare_actions(_slab[node._first + parent].move, move)) {
+            break;
+        }
+        _slab[node._first + position].move = _slab[node._first + parent].move;
+        position = parent;
+    }
+    _slab[node._first + position].move = move;
+}
+
+void Tree::make_heap(const Node &node) {
+    for (uint32_t position = node._nb_moves / 2; position-- > 0;) {
+        const Action move = _slab[node._first + position].move;
+        sift_down(node, position, move);
+    }
+}
+
+NodeId Tree::add_child(const NodeId parent,
+                       const Action &move,
+                       const std::vector<Action> &possible_moves) {
+    Node &p = _nodes[parent];
+    const NodeId child = allocate(p._depth + 1, move, possible_moves);
+    Node &c = _nodes[child];
+    c._virtual_loss = 1;
+    const std::lock_guard<SpinLock> lock(p._lock);
+    --p._nb_expanding;
+    if (p._detached) {
+        // the parent has been removed during the turn, the child is freed at its update
+        c._detached = true;
+    } else {
+        _slab[p._first + p._nb_children].child = child;
+        c._rank = p._nb_children;
+        ++p._nb_children;
+    }
+    return child;
+}
+
+void Tree::update(const std::vector<NodeId> &path, const double score) {
+    std::vector<NodeId> freed;
+    NodeId child = no_node;
+    for (auto node = path.rbegin(); node != path.rend(); ++node) {
+        update_node(*node, child, score, freed);
+        child = *node;
+    }
+    // the root has no parent to remove its virtual loss
+    --_nodes[_root]._virtual_loss;
+    release(freed);
+}
+
+void Tree::update_node(const NodeId node,
+                       const NodeId child,
+                       const double score,
+                       std::vector<NodeId> &freed) {
+    Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    const int visits = n._visits + 1;
+    n._score = ((n._score * (visits - 1)) + score) / visits;
+    n._visits = visits;
+    if (child == no_node or not leave_child(n, child, freed)) {
+        return;
+    }
+    // only the score of the child of the path has changed, it moves up or down to its
+    // rank, the equal scores keep their order
+    Node &c = _nodes[child];
+    c._rank_score = c._score;
+    uint32_t rank = c._rank;
+    while (rank > 0 and
+           _nodes[_slab[n._first + rank - 1].child]._rank_score < c._rank_score) {
+        const NodeId other = _slab[n._first + rank - 1].child;
+        _slab[n._first + rank].child = other;
+        _nodes[other]._rank = rank;
+        --rank;
+    }
+    while (rank + 1 < n._nb_children and
+           _nodes[_slab[n._first + rank + 1].child]._rank_score > c._rank_score) {
+        const NodeId other = _slab[n._first + rank + 1].child;
+        _slab[n._first + rank].child = other;
+        _nodes[other]._rank = rank;
+        ++rank;
+    }
+    _slab[n._first + rank].child = child;
+    c._rank = rank;
+}
+
+bool Tree::leave_child(Node &node, const NodeId child, std::vector<NodeId> &freed) {
+    Node &c = _nodes[child];
+    // removed with the lock of the parent as it is added (see select_child)
+    --c._virtual_loss;
+    if (c._detached) {
+        // the last turn through a removed node frees it
+        if (c._virtual_loss == 0) {
+            freed.push_back(child);
+        }
+        return false;
+    }
+    if (fully_explored(child)) {
+        // delete empty child
+        remove_child(node, c._rank);
+        detach(child, freed);
+        return false;
+    }
+    return true;
+}
+
+void Tree::abandon(const std::vector<NodeId> &path) {
+    std::vector<NodeId> freed;
+    NodeId child = no_node;
+    for (auto node = path.rbegin(); node != path.rend(); ++node) {
+        if (child != no_node) {
+            Node &n = _nodes[*node];
+            const std::lock_guard<SpinLock> lock(n._lock);
+            leave_child(n, child, freed);
+        }
+        child = *node;
+    }
+    // the root has no parent to remove its virtual loss
+    --_nodes[_root]._virtual_loss;
+    release(freed);
+}
+
+void Tree::remove_child(Node &node, const uint32_t rank) {
+    for (uint32_t i = rank + 1; i < node._nb_children; ++i) {
+        const NodeId other = _slab[node._first + i].child;
+        _slab[node._first + i - 1].child = other;
+        _nodes[other]._rank = i - 1;
+    }
+    --node._nb_children;
+}
+
+bool Tree::evict(const std::size_t target) {
+    if (_evicting.exchange(true)) {
+        return false;
+    }
+    const std::size_t memory = _memory;
+    if (memory <= target) {
+        _evicting = false;
+        return false;
+    }
+    // the descendants of a node have less visits than the node, evicting the nodes with
+    // the fewest visits evicts whole subtrees
+    std::vector<std::pair<int, std::size_t>> visits;
+    collect_visits(_root, visits);
+    std::sort(visits.begin(), visits.end());
+    const std::size_t to_free = memory - target;
+    int threshold = 0;
+    std::size_t below_threshold = 0;
+    std::size_t total = 0;
+    for (const auto &[nb_visits, bytes] : visits) {
+        if (nb_visits != threshold) {
+            threshold = nb_visits;
+            below_threshold = total;
+        }
+        total += bytes;
+        if (total >= to_free) {
+            break;
+        }
+    }
+    std::size_t quota = to_free - below_threshold;
+    std::vector<NodeId> freed;
+    evict(_root, threshold, quota, freed);
+    release(freed);
+    _evicting = false;
+    return true;
+}
+
+void Tree::collect_visits(const NodeId node,
+                          std::vector<std::pair<int, std::size_t>> &visits) const {
+    const Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    for (uint32_t i = 0; i < n._nb_children; ++i) {
+        const NodeId child = _slab[n._first + i].child;
+        const Node &c = _nodes[child];
+        visits.emplace_back(c._visits, node_memory(c._capacity));
+        collect_visits(child, visits);
+    }
+}
+
+void Tree::evict(const NodeId node,
+                 const int threshold,
+                 std::size_t &quota,
+                 std::vector<NodeId> &freed) {
+    Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    validate(n, freed);
+    // the children of lowest rank are evicted first, the next children don't move
+    for (uint32_t i = n._nb_children; i-- > 0;) {
+        const NodeId child = _slab[n._first + i].child;
+        Node &c = _nodes[child];
+        const int visits = c._visits;
+        const bool evicted =
+            c._virtual_loss == 0 and
+            (visits < threshold or (visits == threshold and quota > 0));
+        if (not evicted) {
+            evict(child, threshold, quota, freed);
+            continue;
+        }
+        if (visits == threshold) {
+            const std::size_t memory = node_memory(c._capacity);
+            quota -= std::min(quota, memory);
+        }
+        // the child goes back to the possible moves, its place in the range is free
+        remove_child(n, i);
+        push_move(n, c._move);
+        detach(child, freed);
+    }
+}
+
+void Tree::prune(const int score) {
+    int bound = _bound;
+    while (score < bound and not _bound.compare_exchange_weak(bound, score)) {
+    }
+}
+
+[[nodiscard]] const Action &Tree::move(const NodeId node) const {
+    return _nodes[node]._move;
+}
+
+[[nodiscard]] int Tree::get_depth(const NodeId node) const {
+    return _nodes[node]._depth;
+}
+
+[[nodiscard]] bool Tree::terminal(const NodeId node) const {
+    const Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    return n._nb_moves > 0;
+}
+
+[[nodiscard]] bool Tree::fully_explored(const NodeId node) const {
+    const Node &n = _nodes[node];
+    const std::lock_guard<SpinLock> lock(n._lock);
+    return n._nb_moves == 0 and n._nb_children == 0 and n._nb_expanding == 0;
+}
+
+void Tree::save(BinaryWriter &writer) const {
+    writer.write(_bound.load());
+    save(_root, writer);
+}
+
+void Tree::save(const NodeId node, BinaryWriter &writer) const {
+    const Node &n = _nodes[node];
+    writer.write(n._move);
+    writer.write(n._visits.load());
+    writer.write(n._score.load());
+    writer.write(n._rank_score);
+    writer.write(n._nb_moves);
+    for (uint32_t i = 0; i < n._nb_moves; ++i) {
+        writer.write(_slab[n._first + i].move);
+    }
+    writer.write(n._nb_children);
+    for (uint32_t i = 0; i < n._nb_children; ++i) {
+        save(_slab[n._first + i].child, writer);
+    }
+}
+
+NodeId Tree::load(const int depth, BinaryReader &reader) {
+    // a range has at most one place per color, one more color than vertices
+    const auto max_range = static_cast<uint64_t>(Graph::g->nb_vertices) + 1;
+    const auto move = reader.read<Action>();
+    const auto visits = reader.read<int>();
+    const auto score = reader.read<double>();
+    const auto rank_score = reader.read<double>();
+    const auto nb_moves = reader.read<uint32_t>();
+    std::vector<Action> possible_moves;
+    for (uint32_t i = 0; i < nb_moves and i < max_range and not reader.failed(); ++i) {
+        possible_moves.push_back(reader.read<Action>());
+    }
+    const auto nb_children = reader.read<uint32_t>();
+    if (reader.failed() or nb_moves + uint64_t{nb_children} > max_range) {
+        reader.fail();
+        return allocate(depth, move, {});
+    }
+    // the range has a place for each possible move and each child
+    possible_moves.resize(possible_moves.size() + nb_children);
+    const NodeId id = allocate(depth, move, possible_moves);
+    Node &n = _nodes[id];
+    n._nb_moves = nb_moves;
+    n._visits = visits;
+    n._score = score;
+    n._rank_score = rank_score;
+    for (uint32_t i = 0; i < nb_children and not reader.failed(); ++i) {
+        const NodeId child = load(depth + 1, reader);
+        _slab[n._first + i].child = child;
+        _nodes[child]._rank = i;
+        ++n._nb_children;
+    }
+    return id;
+}
+
+[[nodiscard]] std::size_t Tree::memory() const {
+    return _memory;
+}
+
+[[nodiscard]] std::size_t Tree::peak_memory() const {
+    return _peak_memory;
+}
+
+[[nodiscard]] std::size_t Tree::memory_size() const {
+    return _nodes.memory_size() + _slab.memory_size();
+}
+
+[[nodiscard]] std::string Tree::to_dot() const {
+    return "digraph G{\n" + to_dot(_root) + "\n}";
+}
+
+[[nodiscard]] std::string Tree::to_dot(const NodeId node) const {
+    std::string txt;
+    const Node &n = _nodes[node];
+    for (uint32_t i = 0; i < n._nb_children; ++i) {
+        txt += fmt::format("\n\tn{} -> n{} ;", node, _slab[n._first + i].child);
+    }
+    for (uint32_t i = 0; i < n._nb_children; ++i) {
+        txt += to_dot(_slab[n._first + i].child);
+    }
+    return txt;
+}
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils/binary_stream.hpp"
+#include "../utils/chunked_array.hpp"
+#include "../utils/spin_lock.hpp"
+#include "Node.hpp"
+#include "enum_types.hpp"
+
+/**
+ * @brief Tree of a MCTS, the nodes are stored in an arena and referenced by their 32 bits
+ * index
+ *
+ * The nodes and the ranges of the slab (possible moves and children of a node) are
+ * allocated by chunks and recycled, a pruned subtree is given back in one go. A freed
+ * range is merged with the free ranges next to it and a new range is cut from the
+ * smallest free range large enough, so the ranges of any size reuse the freed memory.
+ * A node removed from the tree while threads are in a turn through it (virtual loss) is
+ * detached and freed at the end of the last turn so the indices held by the threads
+ * stay valid
+ *
+ * The pruning with the best found score is lazy : the tree only keeps the score bound,
+ * the possible moves and children of a node are pruned when the selection reaches the
+ * node and the empty nodes are removed on the way back of the turn
+ *
+ * The memory of the tree can be bounded : when it exceeds its budget, the subtrees with
+ * the fewest visits are evicted, their root collapses back into a possible move of its
+ * parent to be expanded again later
+ *
+ */
+class Tree {
+  private:
+    /** @brief No node (child of a leaf)*/
+    static constexpr NodeId no_node = std::numeric_limits<NodeId>::max();
+
+    /** @brief Possible move and child of a place in the range of a node*/
+    struct SlabEntry {
+        /** @brief Possible move*/
+        Action move;
+        /** @brief Child*/
+        NodeId child;
+    };
+
+    /** @brief Nodes of the tree*/
+    ChunkedArray<Node> _nodes;
+    /** @brief Ranges of the possible moves and children of the nodes*/
+    ChunkedArray<SlabEntry> _slab;
+    /** @brief Protect the allocation of the nodes and ranges*/
+    SpinLock _arena_lock{};
+    /** @brief Freed nodes*/
+    std::vector<NodeId> _free_nodes{};
+    /** @brief Freed ranges of the slab, size of each range by its first position*/
+    std::map<uint32_t, uint32_t> _free_ranges{};
+    /** @brief Freed ranges of the slab by size then first position (best fit)*/
+    std::set<std::pair<uint32_t, uint32_t>> _free_sizes{};
+    /** @brief Number of nodes currently in the tree*/
+    long _nb_nodes{0};
+    /** @brief Memory used by the nodes currently in the tree and their ranges in bytes*/
+    std::atomic<std::size_t> _memory{0};
+    /** @brief Highest memory used by the nodes of the tree in bytes*/
+    std::atomic<std::size_t> _peak_memory{0};
+    /** @brief True while a thread evicts subtrees*/
+    std::atomic<bool> _evicting{false};
+    /** @brief Root of the tree*/
+    NodeId _root;
+    /** @brief The moves with a score equal or superior to the bound lead to no better
+     * solution*/
+    std::atomic<int> _bound{std::numeric_limits<int>::max()};
+
+    /**
+     * @brief Return the memory of a node and its range in bytes
+     *
+     * @param capacity size of the range of the node
+     */
+    [[nodiscard]] static std::size_t node_memory(const uint32_t capacity);
+
+    /**
+     * @brief Create a node with its possible moves
+     *
+     * @param depth depth of the node
+     * @param move Action that lead to the node
+     * @param possible_moves possible actions that create children to the node, as a heap
+     * ordered by compare_actions
+     * @return NodeId the new node
+     */
+    NodeId allocate(const int depth,
+                    const Action &move,
+                    const std::vector<Action> &possible_moves);
+
+    /**
+     * @brief Return a range of the slab, cut from a free range if possible (must be
+     * called with the arena lock)
+     *
+     * @param capacity size of the range
+     * @return uint32_t first position of the range
+     */
+    uint32_t allocate_range(const uint32_t capacity);
+
+    /**
+     * @brief Give a range of the slab back, merged with the free ranges next to it (must
+     * be called with the arena lock)
+     *
+     * @param first first position of the range
+     * @param capacity size of the range
+     */
+    void release_range(uint32_t first, uint32_t capacity);
+
+    /**
+     * @brief Give the nodes and their ranges back to the free lists
+     *
+     * @param nodes nodes removed from the tree
+     */
+    void release(const std::vector<NodeId> &nodes);
+
+    /**
+     * @brief Remove a node and its subtree, the nodes without thread in a turn through
+     * them are added to freed, the other ones are detached (must be called with the lock
+     * of the parent)
+     *
+     * @param node the node to remove
+     * @param freed the nodes to free
+     */
+    void detach(const NodeId node, std::vector<NodeId> &freed);
+
+    /**
+     * @brief Delete the possible children and children of the node if their score is
+     * equal or superior to the bound of the tree, if not done since the last change of
+     * the bound (must be called with the lock of the node)
+     *
+     * @param node the node
+     * @param freed the nodes to free
+     */
+    void validate(Node &node, std::vector<NodeId> &freed);
+
+    /**
+     * @brief Place a move in the heap of the possible moves of the node, the moves that
+     * must be taken before it go up (must be called with the lock of the node)
+     *
+     * @param node the node
+     * @param position free position in the heap
+     * @param move the move to place
+     */
+    void sift_down(const Node &node, uint32_t position, const Action &move);
+
+    /**
+     * @brief Add a move to the heap of the possible moves of the node, there must be a
+     * free place in its range (must be called with the lock of the node)
+     *
+     * @param node the node
+     * @param move the move
+     */
+    void push_move(Node &node, const Action &move);
+
+    /**
+     * @brief Rebuild the heap of the possible moves of the node (must be called with the
+     * lock of the node)
+     *
+     * @param node the node
+     */
+    void make_heap(const Node &node);
+
+    /**
+     * @brief Remove the virtual loss of the child of the path, delete the child if it
+     * leads to no children (must be called with the lock of the parent)
+     *
+     * @param node the parent
+     * @param child the child of the path
+     * @param freed the nodes to free
+     * @return true the child stays in the tree
+     * @return false the child has been removed
+     */
+    bool leave_child(Node &node, const NodeId child, std::vector<NodeId> &freed);
+
+    /**
+     * @brief Update a node of the path of a turn, remove the virtual loss of the child of
+     * the path and move the child to its rank among the children (the other children are
+     * sorted, the order is the one of a stable sort). Delete the child if it leads to no
+     * children
+     *
+     * @param node the node
+     * @param child the child of the node in the path, no_node for the leaf
+     * @param score new score
+     * @param freed the nodes to free
+     */
+    void update_node(const NodeId node,
+                     const NodeId child,
+                     const double score,
+                     std::vector<NodeId> &freed);
+
+    /**
+     * @brief Remove a child from the children of a node, the next children move up by one
+     * rank (must be called with the lock of the node)
+     *
+     * @param node the node
+     * @param rank rank of the child
+     */
+    void remove_child(Node &node, const uint32_t rank);
+
+    /**
+     * @brief Return the UCB score of the child for the selection, computed from its rank
+     * and visits. The score is lowered if other threads are in a turn through the child
+     * so they don't all follow the same branch (must be called with the lock of the
+     * parent)
+     *
+     * @param parent the parent
+     * @param child the child
+     * @param sum_rank sum of the ranks of the children
+     * @param log_visits log of the number of visits of the parent
+     * @return double the UCB score with the virtual loss
+     */
+    [[nodiscard]] double score_ucb(const Node &parent,
+                                   const Node &child,
+                                   const double sum_rank,
+                                   const double log_visits) const;
+
+    /**
+     * @brief Add the number of visits and the memory of each node of the subtree (except
+     * the node)
+     *
+     * @param node the root of the subtree
+     * @param visits visits and memory in bytes of the nodes
+     */
+    void collect_visits(const NodeId node,
+                        std::vector<std::pair<int, std::size_t>> &visits) const;
+
+    /**
+     * @brief Evict the subtrees of the children with less visits than the threshold, or
+     * as many visits while the quota isn't reached (the children of lowest rank first).
+     * The evicted children go back to the possible moves of their parent, the children
+     * with a virtual loss are kept
+     *
+     * @param node the root of the subtree
+     * @param threshold number of visits of the evicted children
+     * @param quota memory still to free with the children with as many visits as the
+     * threshold
+     * @param freed the nodes to free
+     */
+    void evict(const NodeId node,
+               const int threshold,
+               std::size_t &quota,
+               std::vector<NodeId> &freed);
+
+    /**
+     * @brief Write a node and its subtree (preorder)
+     *
+     * @param node the node
+     * @param writer the checkpoint
+     */
+    void save(const NodeId node, BinaryWriter &writer) const;
+
+    /**
+     * @brief Read a node and its subtree written by save
+     *
+     * @param depth depth of the node
+     * @param reader the checkpoint
+     * @return NodeId the node
+     */
+    NodeId load(const int depth, BinaryReader &reader);
+
+    /**
+     * @brief Convert the subtree of a node to dot format
+     *
+     * @param node the node
+     * @return std::string dot string
+     */
+    [[nodiscard]] std::string to_dot(const NodeId node) const;
+
+  public:
+    /**
+     * @brief Construct a tree with its root
+     *
+     * @param move Action that lead to the root
+     * @param possible_moves possible actions that create children to the root
+     */
+    Tree(const Action &move, const std::vector<Action> &possible_moves);
+
+    /**
+     * @brief Construct a tree written in a checkpoint by save
+     *
+     * @param reader the checkpoint
+     */
+    explicit Tree(BinaryReader &reader);
+
+    Tree(const Tree &) = delete;
+    Tree &operator=(const Tree &) = delete;
+
+    ~Tree();
+
+    /**
+     * @brief Return the root of the tree
+     *
+     * @return NodeId the root
+     */
+    [[nodiscard]] NodeId root() const;
+
+    /**
+     * @brief Add a virtual loss to the root, a thread starts a turn
+     *
+     */
+    void enter_root();
+
+    /**
+     * @brief Choose the child with the highest UCB score (with the virtual loss) and add
+     * a virtual loss to it, the ties are broken randomly. The node and the chosen child
+     * are pruned with the bound of the tree first, a child left empty is deleted and
+     * another one is chosen
+     *
+     * @param node the parent
+     * @param child the chosen child
+     * @return true a child is chosen
+     * @return false the node has no child
+     */
+    [[nodiscard]] bool select_child(const NodeId node, NodeId &child);
+
+    /**
+     * @brief Take the action of the next child of the node, the possible move with the
+     * lowest score (the possible moves are kept as a heap). The node is not fully
+     * explored until the child is given with add_child or skip_child
+     *
+     * @param node the node
+     * @param move the action of the next child
+     * @return true the action is taken
+     * @return false no possible child left (taken by another thread or pruned)
+     */
+    [[nodiscard]] bool next_child(const NodeId node, Action &move);
+
+    /**
+     * @brief Give up the action taken with next_child, no child is added for it
+     *
+     * @param node the node
+     */
+    void skip_child(const NodeId node);
+
+    /**
+     * @brief Create a child with a virtual loss and add it to its parent
+     *
+     * @param parent the parent
+     * @param move Action that lead to the child (taken with next_child)
+     * @param possible_moves possible actions that create children to the child
+     * @return NodeId the child
+     */
+    NodeId add_child(const NodeId parent,
+                     const Action &move,
+                     const std::vector<Action> &possible_moves);
+
+    /**
+     * @brief Update the nodes of a turn from the leaf to the root, recalculate their
+     * score, increment their number of visits, update the rank of the child of the path
+     * and remove the virtual loss of the turn. Delete children that lead to no children
+     *
+     * @param path nodes of the turn from the root to the leaf
+     * @param score new score
+     */
+    void update(const std::vector<NodeId> &path, const double score);
+
+    /**
+     * @brief Stop a turn without score (the selection reached a node emptied by the
+     * pruning), remove the virtual loss of the turn and delete the nodes left empty from
+     * the leaf to the root
+     *
+     * @param path nodes of the turn from the root to the leaf
+     */
+    void abandon(const std::vector<NodeId> &path);
+
+    /**
+     * @brief Lower the score bound of the tree to the best found score, the nodes are
+     * pruned lazily
+     *
+     * @param score best found score
+     */
+    void prune(const int score);
+
+    /**
+     * @brief Return the move that lead to the node
+     *
+     * @param node the node
+     * @return const Action& the move
+     */
+    [[nodiscard]] const Action &move(const NodeId node) const;
+
+    /**
+     * @brief Get the depth of the node
+     *
+     * @param node the node
+     * @return int depth of the node
+     */
+    [[nodiscard]] int get_depth(const NodeId node) const;
+
+    /**
+     * @brief A node is terminal for the selection if it still has possible children, the
+     * selection stops on it to expand it
+     *
+     * @param node the node
+     * @return true the node has at least one possible child
+     * @return false the node has no possible child
+     */
+    [[nodiscard]] bool terminal(const NodeId node) const;
+
+    /**
+     * @brief A node is fully explored if it has no child, no possible child and no
+     * child being added by a thread
+     *
+     * @param node the node
+     * @return true the node is fully explored
+     * @return false the branch of the node can grow
+     */
+    [[nodiscard]] bool fully_explored(const NodeId node) const;
+
+    /**
+     * @brief Evict the subtrees with the fewest visits until the memory of the tree is
+     * under the target. Nothing is done if another thread is evicting
+     *
+     * @param target memory of the tree to reach in bytes
+     * @return true subtrees have been evicted
+     * @return false another thread is evicting or the memory is already under the target
+     */
+    bool evict(const std::size_t target);
+
+    /**
+     * @brief Write the tree with the score bound, the visits, scores, possible moves and
+     * children of its nodes (no thread must be in a turn)
+     *
+     * @param writer the checkpoint
+     */
+    void save(BinaryWriter &writer) const;
+
+    /**
+     * @brief Return the memory used by the nodes of the tree and their ranges in bytes
+     */
+    [[nodiscard]] std::size_t memory() const;
+
+    /**
+     * @brief Return the highest memory used by the nodes of the tree and their ranges in
+     * bytes
+     */
+    [[nodiscard]] std::size_t peak_memory() const;
+
+    /**
+     * @brief Return the memory used by the arena in bytes
+     */
+    [[nodiscard]] std::size_t memory_size() const;
+
+    /**
+     * @brief Convert the tree to dot format
+     *
+     * @return std::string dot string
+     */
+    [[nodiscard]] std::string to_dot() const;
+};
@@ -0,0 +1,63 @@
+#include "binary_stream.hpp"
+
+#include <cstdio>
+
+#include <unistd.h>
+
+void BinaryWriter::write_string(const std::string &text) {
+    write_vector(std::vector<char>(text.begin(), text.end()));
+}
+
+[[nodiscard]] bool BinaryWriter::to_file(const std::string &file_name) const {
+    const std::string tmp_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+    std::FILE *file = std::fopen(tmp_name.c_str(), "wb");
+    if (not file) {
+        return false;
+    }
+    const bool written = std::fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+    if (std::fclose(file) != 0 or not written or
+        std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BinaryReader::available(const std::size_t nb_bytes) {
+    if (_failed or nb_bytes > _data.size() - _position) {
+        _failed = true;
+        return false;
+    }
+    return true;
+}
+
+[[nodiscard]] bool BinaryReader::from_file(const std::string &file_name) {
+    std::FILE *file = std::fopen(file_name.c_str(), "rb");
+    if (not file) {
+        return false;
+    }
+    _data.clear();
+    _position = 0;
+    _failed = false;
+    char buffer[1 << 16];
+    std::size_t nb_read;
+    while ((nb_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        _data.insert(_data.end(), buffer, buffer + nb_read);
+    }
+    const bool read = std::ferror(file) == 0;
+    std::fclose(file);
+    return read;
+}
+
+[[nodiscard]] std::string BinaryReader::read_string() {
+    const auto characters = read_vector<char>();
+    return std::string(characters.begin(), characters.end());
+}
+
+[[nodiscard]] bool BinaryReader::failed() const {
+    return _failed;
+}
+
+void BinaryReader::fail() {
+    _failed = true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Buffer of binary values written to a file in one go
+ *
+ * The values are written with their memory representation, the file is only meant to be
+ * read back by the same build on the same machine (checkpoints of the search)
+ *
+ */
+class BinaryWriter {
+  private:
+    /** @brief Bytes written*/
+    std::vector<char> _data{};
+
+  public:
+    /**
+     * @brief Write a value
+     *
+     * @tparam T trivially copyable type
+     * @param value the value
+     */
+    template <typename T> void write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto *bytes = reinterpret_cast<const char *>(&value);
+        _data.insert(_data.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+     * @brief Write the size of the vector and its values
+     *
+     * @tparam T trivially copyable type
+     * @param values the values
+     */
+    template <typename T> void write_vector(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint64_t>(values.size()));
+        const auto *bytes = reinterpret_cast<const char *>(values.data());
+        _data.insert(_data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Write the size of the string and its characters
+     *
+     * @param text the string
+     */
+    void write_string(const std::string &text);
+
+    /**
+     * @brief Write the buffer to a file, the file is replaced at once so a reader never
+     * sees a partial file
+     *
+     * @param file_name name of the file
+     * @return true the file is written
+     * @return false the file can't be written
+     */
+    [[nodiscard]] bool to_file(const std::string &file_name) const;
+};
+
+/**
+ * @brief Reader of the values of a file written by BinaryWriter
+ *
+ * A read past the end of the file gives default values and sets the reader as failed
+ *
+ */
+class BinaryReader {
+  private:
+    /** @brief Bytes of the file*/
+    std::vector<char> _data{};
+    /** @brief Position of the next value*/
+    std::size_t _position{0};
+    /** @brief True if a read went past the end of the file*/
+    bool _failed{false};
+
+    /**
+     * @brief Check that the next bytes are in the file, set the reader as failed if not
+     *
+     * @param nb_bytes number of bytes to read
+     * @return true the bytes can be read
+     */
+    bool available(const std::size_t nb_bytes);
+
+  public:
+    /**
+     * @brief Load the file
+     *
+     * @param file_name name of the file
+     * @return true the file is loaded
+     * @return false the file can't be read
+     */
+    [[nodiscard]] bool from_file(const std::string &file_name);
+
+    /**
+     * @brief Read a value
+     *
+     * @tparam T trivially copyable type
+     * @return T the value
+     */
+    template <typename T> [[nodiscard]] T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (available(sizeof(T))) {
+            std::memcpy(&value, _data.data() + _position, sizeof(T));
+            _position += sizeof(T);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Read a vector written with write_vector
+     *
+     * @tparam T trivially copyable type
+     * @return std::vector<T> the values
+     */
+    template <typename T> [[nodiscard]] std::vector<T> read_vector() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto size = read<uint64_t>();
+        if (size > _data.size() / sizeof(T) or not available(size * sizeof(T))) {
+            _failed = true;
+            return {};
+        }
+        std::vector<T> values(size);
+        std::memcpy(values.data(), _data.data() + _position, size * sizeof(T));
+        _position += size * sizeof(T);
+        return values;
+    }
+
+    /**
+     * @brief Read a string written with write_string
+     *
+     * @return std::string the string
+     */
+    [[nodiscard]] std::string read_string();
+
+    /**
+     * @brief Return true if a read went past the end of the file
+     *
+     * @return true the values read are not valid
+     */
+    [[nodiscard]] bool failed() const;
+
+    /**
+     * @brief Set the reader as failed (the values read are not consistent)
+     *
+     */
+    void fail();
+};
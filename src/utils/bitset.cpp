@@ -0,0 +1,86 @@
+#include "bitset.hpp"
+
+#include <immintrin.h>
+
+/**
+ * @brief Scalar version of popcount_and
+ */
+static int popcount_and_scalar(const uint64_t *words1,
+                               const uint64_t *words2,
+                               const std::size_t nb_words) {
+    int count = 0;
+    for (std::size_t i = 0; i < nb_words; ++i) {
+        count += __builtin_popcountll(words1[i] & words2[i]);
+    }
+    return count;
+}
+
+/**
+ * @brief AVX2 version of popcount_and, count the bits of each nibble with a lookup table
+ * then sum the bytes of each 64 bits lane
+ */
+__attribute__((target("avx2"))) static int popcount_and_avx2(const uint64_t *words1,
+                                                             const uint64_t *words2,
+                                                             const std::size_t nb_words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= nb_words; i += 4) {
+        const __m256i words = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words1 + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words2 + i)));
+        const __m256i low = _mm256_and_si256(words, low_mask);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(words, 4), low_mask);
+        const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                               _mm256_shuffle_epi8(lookup, high));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+    return static_cast<int>(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           popcount_and_scalar(words1 + i, words2 + i, nb_words - i);
+}
+
+/**
+ * @brief AVX-512 version of popcount_and, use the 64 bits lanes popcount instruction
+ */
+__attribute__((target("avx512f,avx512vpopcntdq"))) static int
+popcount_and_avx512(const uint64_t *words1,
+                    const uint64_t *words2,
+                    const std::size_t nb_words) {
+    __m512i total = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8 <= nb_words; i += 8) {
+        const __m512i words = _mm512_and_si512(_mm512_loadu_si512(words1 + i),
+                                               _mm512_loadu_si512(words2 + i));
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(words));
+    }
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, total);
+    uint64_t count = 0;
+    for (const uint64_t lane : lanes) {
+        count += lane;
+    }
+    return static_cast<int>(count) +
+           popcount_and_scalar(words1 + i, words2 + i, nb_words - i);
+}
+
+/** @brief Kernel used by popcount_and, chosen once according to the CPU*/
+static const auto popcount_and_kernel = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        return &popcount_and_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return &popcount_and_avx2;
+    }
+    return &popcount_and_scalar;
+}();
+
+[[nodiscard]] int popcount_and(const uint64_t *words1,
+                               const uint64_t *words2,
+                               const std::size_t nb_words) {
+    return popcount_and_kernel(words1, words2, nb_words);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Allocator returning memory aligned on the given boundary
+ *
+ * @tparam T type of the elements
+ * @tparam Alignment alignment in bytes (power of 2)
+ */
+template <typename T, std::size_t Alignment> struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    explicit AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {
+    }
+
+    [[nodiscard]] T *allocate(const std::size_t n) {
+        const std::size_t size =
+            (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void *data = std::aligned_alloc(Alignment, size);
+        if (not data) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(data);
+    }
+
+    void deallocate(T *data, const std::size_t) noexcept {
+        std::free(data);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+        return false;
+    }
+};
+
+/** @brief Words of one or several bitsets, 64 bytes aligned*/
+using BitsetWords = std::vector<uint64_t, AlignedAllocator<uint64_t, 64>>;
+
+/**
+ * @brief Return the number of words of a bitset, rounded up to a multiple of 8 words so
+ * each bitset of a BitsetWords starts on a 64 bytes boundary
+ *
+ * @param nb_bits number of bits of the bitset
+ * @return std::size_t number of 64 bits words
+ */
+[[nodiscard]] inline std::size_t bitset_nb_words(const int nb_bits) {
+    const std::size_t nb_words = (static_cast<std::size_t>(nb_bits) + 63) / 64;
+    return (nb_words + 7) / 8 * 8;
+}
+
+/**
+ * @brief Set the bit to 1
+ *
+ * @param words the bitset
+ * @param bit the bit
+ */
+inline void bitset_set(uint64_t *words, const int bit) {
+    words[bit / 64] |= uint64_t{1} << (bit % 64);
+}
+
+/**
+ * @brief Set the bit to 0
+ *
+ * @param words the bitset
+ * @param bit the bit
+ */
+inline void bitset_reset(uint64_t *words, const int bit) {
+    words[bit / 64] &= ~(uint64_t{1} << (bit % 64));
+}
+
+/**
+ * @brief Return the value of the bit
+ *
+ * @param words the bitset
+ * @param bit the bit
+ * @return true the bit is set
+ * @return false the bit is not set
+ */
+[[nodiscard]] inline bool bitset_test(const uint64_t *words, const int bit) {
+    return (words[bit / 64] >> (bit % 64)) & 1;
+}
+
+/**
+ * @brief Call the function on each set bit of the bitset, by increasing position
+ *
+ * @tparam Function function(int bit)
+ * @param words the bitset
+ * @param nb_words number of words of the bitset
+ * @param function the function to call
+ */
+template <typename Function>
+void bitset_for_each(const uint64_t *words, const std::size_t nb_words, Function function) {
+    for (std::size_t i = 0; i < nb_words; ++i) {
+        uint64_t word = words[i];
+        while (word != 0) {
+            function(static_cast<int>(i * 64) + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+/**
+ * @brief Return the position of the first set bit at or after the given position
+ *
+ * @param words the bitset
+ * @param nb_words number of words of the bitset
+ * @param from first position to look at
+ * @return int position of the bit, -1 if there is none
+ */
+[[nodiscard]] inline int
+bitset_find_next(const uint64_t *words, const std::size_t nb_words, const int from) {
+    std::size_t i = static_cast<std::size_t>(from) / 64;
+    if (i >= nb_words) {
+        return -1;
+    }
+    uint64_t word = words[i] & (~uint64_t{0} << (from % 64));
+    while (word == 0) {
+        if (++i == nb_words) {
+            return -1;
+        }
+        word = words[i];
+    }
+    return static_cast<int>(i * 64) + __builtin_ctzll(word);
+}
+
+/**
+ * @brief Return the number of bits set in both bitsets, popcount(words1 & words2)
+ *
+ * The AVX-512 (VPOPCNTDQ) or AVX2 kernel is selected at startup according to the CPU,
+ * the scalar version is used otherwise
+ *
+ * @param words1 first bitset
+ * @param words2 second bitset
+ * @param nb_words number of words to compare
+ * @return int number of common bits
+ */
+[[nodiscard]] int popcount_and(const uint64_t *words1,
+                               const uint64_t *words2,
+                               const std::size_t nb_words);
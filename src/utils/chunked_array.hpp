@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Array of elements allocated by chunks of 2^shift elements, indexed on 32 bits
+ *
+ * The elements never move so an element can be read by a thread while another one grows
+ * the array (the growth itself must be protected by the caller). The table of the chunks
+ * is allocated once for all the possible indices
+ *
+ * @tparam T type of the elements (default constructible)
+ */
+template <typename T>
+class ChunkedArray {
+  private:
+    /** @brief log2 of the number of elements of a chunk*/
+    int _shift;
+    /** @brief Mask of the position in a chunk*/
+    uint32_t _mask;
+    /** @brief Chunks of elements*/
+    std::vector<std::unique_ptr<T[]>> _chunks{};
+    /** @brief Number of elements given by grow*/
+    uint64_t _size{0};
+
+  public:
+    /**
+     * @brief Construct an empty array
+     *
+     * @param shift log2 of the number of elements of a chunk
+     */
+    explicit ChunkedArray(const int shift)
+        : _shift(shift), _mask((uint32_t{1} << shift) - 1) {
+        _chunks.reserve((uint64_t{1} << 32) >> shift);
+    }
+
+    /**
+     * @brief Return the element at the given index
+     */
+    [[nodiscard]] T &operator[](const uint32_t index) {
+        return _chunks[index >> _shift][index & _mask];
+    }
+
+    /**
+     * @brief Return the element at the given index
+     */
+    [[nodiscard]] const T &operator[](const uint32_t index) const {
+        return _chunks[index >> _shift][index & _mask];
+    }
+
+    /**
+     * @brief Add contiguous elements at the end of the array, in the same chunk
+     *
+     * @param nb_elements number of elements, at most the size of a chunk
+     * @return uint32_t index of the first element
+     */
+    uint32_t grow(const uint32_t nb_elements) {
+        const uint64_t chunk_size = uint64_t{1} << _shift;
+        assert(nb_elements <= chunk_size);
+        if ((_size & _mask) + nb_elements > chunk_size) {
+            // the end of the current chunk is too short
+            _size = (_size + _mask) & ~uint64_t{_mask};
+        }
+        while (_size + nb_elements > (_chunks.size() << _shift)) {
+            _chunks.emplace_back(std::make_unique<T[]>(chunk_size));
+        }
+        assert(_size + nb_elements <= (uint64_t{1} << 32));
+        const auto first = static_cast<uint32_t>(_size);
+        _size += nb_elements;
+        return first;
+    }
+
+    /**
+     * @brief Return the memory used by the chunks in bytes
+     */
+    [[nodiscard]] std::size_t memory_size() const {
+        return (_chunks.size() << _shift) * sizeof(T) +
+               _chunks.capacity() * sizeof(std::unique_ptr<T[]>);
+    }
+};
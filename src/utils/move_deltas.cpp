@@ -0,0 +1,123 @@
+#include "move_deltas.hpp"
+
+#include <algorithm>
+#include <immintrin.h>
+#include <type_traits>
+
+/**
+ * @brief Scalar version of move_deltas
+ */
+template <typename Count>
+static void move_deltas_scalar(const int *max_weights,
+                               const Count *conflicts_row,
+                               const int nb_colors,
+                               const int weight,
+                               const int base,
+                               const int penalty_coeff,
+                               int *deltas,
+                               int *conflicts) {
+    for (int color = 0; color < nb_colors; ++color) {
+        const int nb_conflicts = conflicts_row[color];
+        conflicts[color] = nb_conflicts;
+        deltas[color] = base + std::max(weight - max_weights[color], 0) +
+                        penalty_coeff * nb_conflicts;
+    }
+}
+
+/**
+ * @brief AVX2 version of move_deltas, 8 colors at a time, the counts on 16 bits are
+ * widened to 32 bits
+ */
+template <typename Count>
+__attribute__((target("avx2"))) static void move_deltas_avx2(const int *max_weights,
+                                                             const Count *conflicts_row,
+                                                             const int nb_colors,
+                                                             const int weight,
+                                                             const int base,
+                                                             const int penalty_coeff,
+                                                             int *deltas,
+                                                             int *conflicts) {
+    const __m256i weights = _mm256_set1_epi32(weight);
+    const __m256i bases = _mm256_set1_epi32(base);
+    const __m256i coeffs = _mm256_set1_epi32(penalty_coeff);
+    const __m256i zero = _mm256_setzero_si256();
+    int color = 0;
+    for (; color + 8 <= nb_colors; color += 8) {
+        const Count *row = conflicts_row + color;
+        __m256i counts;
+        if constexpr (std::is_same_v<Count, uint16_t>) {
+            counts = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(row)));
+        } else {
+            counts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row));
+        }
+        const __m256i max =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(max_weights + color));
+        // only a vertex heavier than the heaviest of the color increases its weight
+        const __m256i enter = _mm256_max_epi32(_mm256_sub_epi32(weights, max), zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(conflicts + color), counts);
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(deltas + color),
+            _mm256_add_epi32(_mm256_add_epi32(bases, enter),
+                             _mm256_mullo_epi32(coeffs, counts)));
+    }
+    move_deltas_scalar(max_weights + color,
+                       conflicts_row + color,
+                       nb_colors - color,
+                       weight,
+                       base,
+                       penalty_coeff,
+                       deltas + color,
+                       conflicts + color);
+}
+
+/**
+ * @brief Return the kernel of move_deltas for the counts, chosen according to the CPU
+ */
+template <typename Count> static auto select_move_deltas_kernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return &move_deltas_avx2<Count>;
+    }
+    return &move_deltas_scalar<Count>;
+}
+
+/** @brief Kernels used by move_deltas, chosen once according to the CPU*/
+static const auto move_deltas_narrow_kernel = select_move_deltas_kernel<uint16_t>();
+static const auto move_deltas_wide_kernel = select_move_deltas_kernel<int>();
+
+void move_deltas(const int *max_weights,
+                 const uint16_t *conflicts_row,
+                 const int nb_colors,
+                 const int weight,
+                 const int base,
+                 const int penalty_coeff,
+                 int *deltas,
+                 int *conflicts) {
+    move_deltas_narrow_kernel(max_weights,
+                              conflicts_row,
+                              nb_colors,
+                              weight,
+                              base,
+                              penalty_coeff,
+                              deltas,
+                              conflicts);
+}
+
+void move_deltas(const int *max_weights,
+                 const int *conflicts_row,
+                 const int nb_colors,
+                 const int weight,
+                 const int base,
+                 const int penalty_coeff,
+                 int *deltas,
+                 int *conflicts) {
+    move_deltas_wide_kernel(max_weights,
+                            conflicts_row,
+                            nb_colors,
+                            weight,
+                            base,
+                            penalty_coeff,
+                            deltas,
+                            conflicts);
+}
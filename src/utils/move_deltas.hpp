@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Compute the deltas of the moves of a vertex to each color at once
+ *
+ * For each color c in [0, nb_colors) :
+ * - conflicts[c] = conflicts_row[c]
+ * - deltas[c] = base + max(weight - max_weights[c], 0) + penalty_coeff * conflicts[c]
+ *
+ * The AVX2 kernel is selected at startup according to the CPU, the scalar version is
+ * used otherwise
+ *
+ * @param max_weights for each color, heaviest weight (0 if empty)
+ * @param conflicts_row for each color, number of neighbors of the vertex in the color
+ * @param nb_colors number of colors
+ * @param weight weight of the vertex
+ * @param base delta of the removal of the vertex from its color
+ * @param penalty_coeff coefficient of the conflicts
+ * @param deltas for each color, delta of the move
+ * @param conflicts for each color, number of conflicts of the vertex in the color
+ */
+void move_deltas(const int *max_weights,
+                 const uint16_t *conflicts_row,
+                 const int nb_colors,
+                 const int weight,
+                 const int base,
+                 const int penalty_coeff,
+                 int *deltas,
+                 int *conflicts);
+
+/**
+ * @brief Compute the deltas of the moves of a vertex to each color at once, with the
+ * conflicts stored on 32 bits, see move_deltas
+ */
+void move_deltas(const int *max_weights,
+                 const int *conflicts_row,
+                 const int nb_colors,
+                 const int weight,
+                 const int base,
+                 const int penalty_coeff,
+                 int *deltas,
+                 int *conflicts);
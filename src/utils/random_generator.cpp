@@ -2,5 +2,5 @@
 
 namespace rd {
 // init generator (set rand seed in src/main.cpp)
-std::mt19937 generator;
+thread_local std::mt19937 generator;
 } // namespace rd
@@ -5,8 +5,9 @@
 #include <vector>
 
 namespace rd {
-/** @brief random number generator*/
-extern std::mt19937 generator;
+/** @brief random number generator, one per thread (the threads of the MCTS seed their
+ * own)*/
+extern thread_local std::mt19937 generator;
 
 /**
  * @brief Get the random value from a non empty container
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Non owning view on a contiguous sequence of elements
+ *
+ * Minimal replacement of std::span (C++20) to iterate over memory owned by another
+ * object (mapped file, buffer of the graph, ...)
+ *
+ * @tparam T type of the elements
+ */
+template <typename T> class Span {
+    /** @brief First element of the sequence*/
+    T *_data{nullptr};
+    /** @brief Number of elements*/
+    std::size_t _size{0};
+
+  public:
+    Span() = default;
+
+    Span(T *data, const std::size_t size) : _data(data), _size(size) {
+    }
+
+    Span(T *first, T *last) : _data(first), _size(static_cast<std::size_t>(last - first)) {
+    }
+
+    [[nodiscard]] T *begin() const {
+        return _data;
+    }
+
+    [[nodiscard]] T *end() const {
+        return _data + _size;
+    }
+
+    [[nodiscard]] T *data() const {
+        return _data;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return _size;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return _size == 0;
+    }
+
+    [[nodiscard]] T &operator[](const std::ptrdiff_t index) const {
+        return _data[index];
+    }
+
+    [[nodiscard]] T &back() const {
+        return _data[_size - 1];
+    }
+};
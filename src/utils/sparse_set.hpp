@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Set of integers in [0, capacity) with O(1) insertion, deletion, membership test
+ * and random access
+ *
+ * The values are stored contiguously (in no particular order), a deletion moves the last
+ * value in place of the deleted one
+ *
+ */
+class SparseSet {
+  private:
+    /** @brief Values of the set*/
+    std::vector<int> _values{};
+    /** @brief For each possible value, its position in _values (-1 if not in the set)*/
+    std::vector<int> _positions{};
+
+  public:
+    /**
+     * @brief Construct an empty set
+     *
+     * @param capacity values must be in [0, capacity)
+     */
+    explicit SparseSet(const int capacity) : _positions(capacity, -1) {
+        _values.reserve(static_cast<std::size_t>(capacity));
+    }
+
+    /**
+     * @brief Add the value to the set if not already in
+     *
+     * @param value the value
+     */
+    void insert(const int value) {
+        if (_positions[value] != -1) {
+            return;
+        }
+        _positions[value] = static_cast<int>(_values.size());
+        _values.push_back(value);
+    }
+
+    /**
+     * @brief Remove the value from the set if in
+     *
+     * @param value the value
+     */
+    void erase(const int value) {
+        const int position = _positions[value];
+        if (position == -1) {
+            return;
+        }
+        const int last = _values.back();
+        _values[position] = last;
+        _positions[last] = position;
+        _values.pop_back();
+        _positions[value] = -1;
+    }
+
+    /**
+     * @brief Remove all the values, in O(size)
+     */
+    void clear() {
+        for (const int value : _values) {
+            _positions[value] = -1;
+        }
+        _values.clear();
+    }
+
+    /**
+     * @brief Return true if the value is in the set
+     */
+    [[nodiscard]] bool contains(const int value) const {
+        return _positions[value] != -1;
+    }
+
+    /**
+     * @brief Return the values of the set, in no particular order
+     */
+    [[nodiscard]] const std::vector<int> &values() const {
+        return _values;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return _values.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return _values.empty();
+    }
+
+    [[nodiscard]] std::vector<int>::const_iterator begin() const {
+        return _values.begin();
+    }
+
+    [[nodiscard]] std::vector<int>::const_iterator end() const {
+        return _values.end();
+    }
+};
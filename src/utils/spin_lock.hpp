@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+/**
+ * @brief Lock of one byte for the small structures shared by the threads and held for a
+ * short time (the nodes of the MCTS tree)
+ *
+ * The thread yields while waiting so a long holder (cleaning of the tree) doesn't burn
+ * the other cores. Usable with std::lock_guard
+ *
+ */
+class SpinLock {
+  private:
+    /** @brief Set while the lock is held*/
+    std::atomic_flag _flag = ATOMIC_FLAG_INIT;
+
+  public:
+    /**
+     * @brief Wait until the lock is free and take it
+     *
+     */
+    void lock() {
+        while (_flag.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Release the lock
+     *
+     */
+    void unlock() {
+        _flag.clear(std::memory_order_release);
+    }
+};
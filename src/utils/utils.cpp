@@ -4,6 +4,8 @@
 #include <iomanip>
 #include <sstream>
 
+#include <sys/resource.h>
+
 std::vector<std::string> split_string(std::string to_split,
                                       const std::string &delimiter) {
     size_t pos = 0;
@@ -23,6 +25,14 @@ std::string get_date_str() {
     return tm.str();
 }
 
+long get_peak_memory_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
 void print_result_ls(const int64_t &best_time,
                      const Solution &solution,
                      const long &turn) {
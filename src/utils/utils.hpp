@@ -104,6 +104,13 @@ std::vector<std::string> split_string(std::string to_split, const std::string &d
  */
 std::string get_date_str();
 
+/**
+ * @brief Get the peak resident memory of the process
+ *
+ * @return long peak memory in KiB
+ */
+long get_peak_memory_kb();
+
 /**
  * @brief Print results for local search
  *